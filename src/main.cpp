@@ -1,4 +1,5 @@
 #include <SDL2/SDL.h>
+#include <box2d/collision.h>
 #include <iostream>
 #include <vector>
 #include <memory>
@@ -9,7 +10,28 @@
 #include <cstring>
 #include <fstream>
 #include <string>
+#include <limits>
 #include <sstream>
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include <new>
+#include <cstdlib>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <tuple>
+#include <climits>
+#include <stdexcept>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define OVERLAP_SIMD_X86 1
+#include <immintrin.h>
+#endif
 
 // ========================
 // Forward Declarations
@@ -25,6 +47,9 @@ class BounceBehaviorComponent;
 class HorizontalMoveBehaviorComponent;
 class SolidComponent;
 class EnemyComponent;
+class TilingBackgroundComponent;
+class DormantComponent;
+class SleepingComponent;
 
 // ========================
 // Camera
@@ -51,6 +76,8 @@ class View {
             : m_centerX(centerX), m_centerY(centerY), m_scale(scale), m_angle(angle) {}
         
         void setCenter(float x, float y) { m_centerX = x; m_centerY = y; }
+        float centerX() const { return m_centerX; }
+        float centerY() const { return m_centerY; }
         void setScale(float scale) { m_scale = scale; }
         void setAngle(float angle) { m_angle = angle; }
         
@@ -75,6 +102,8 @@ class View {
             m_screenWidth = width; 
             m_screenHeight = height; 
         }
+        int screenWidth() const { return m_screenWidth; }
+        int screenHeight() const { return m_screenHeight; }
         
         // Get transformed rectangle for rendering
         SDL_Rect getTransformedRect(float worldX, float worldY, float width, float height) const {
@@ -107,24 +136,38 @@ public:
         std::memcpy(m_previousKeys, m_currentKeys, SDL_NUM_SCANCODES);
         const Uint8* currentKeyState = SDL_GetKeyboardState(nullptr);
         std::memcpy(m_currentKeys, currentKeyState, SDL_NUM_SCANCODES);
+        
+        // Presses stay latched until a simulation tick has seen them, so one
+        // on a frame that runs no fixed tick is not lost
+        for(int key = 0; key < SDL_NUM_SCANCODES; ++key) {
+            if(m_currentKeys[key] && !m_previousKeys[key]) m_pressedSinceTick[key] = 1;
+        }
     }
     
     bool isKeyPressed(SDL_Scancode key) const { 
         return m_currentKeys[key]; 
     }
     
+    // Pressed since the last simulation tick
     bool isKeyJustPressed(SDL_Scancode key) const { 
-        return m_currentKeys[key] && !m_previousKeys[key]; 
+        return m_pressedSinceTick[key]; 
+    }
+    
+    // Called once a simulation tick has read the input
+    void consumeJustPressed() {
+        std::memset(m_pressedSinceTick, 0, SDL_NUM_SCANCODES);
     }
     
 private:
     InputSystem() {
         std::memset(m_currentKeys, 0, SDL_NUM_SCANCODES);
         std::memset(m_previousKeys, 0, SDL_NUM_SCANCODES);
+        std::memset(m_pressedSinceTick, 0, SDL_NUM_SCANCODES);
     }
     
     Uint8 m_currentKeys[SDL_NUM_SCANCODES];
     Uint8 m_previousKeys[SDL_NUM_SCANCODES];
+    Uint8 m_pressedSinceTick[SDL_NUM_SCANCODES];
 };
 
 // ========================
@@ -268,418 +311,3400 @@ class Engine {
         float m_deltaTime = 0.016f;
     };
     
+// ========================
+// Entity Handles
+// ========================
+// 32-bit generational reference to a GameObject: the low bits index a slot
+// in the World's slot map and the high bits hold that slot's generation.
+// Destroying an entity bumps the generation, so stale handles resolve to
+// nullptr instead of dangling. The default handle is null.
+// Generations are only 12 bits, so the World reuses freed slots oldest
+// first, and only once World::kMinFreeSlots are waiting: a slot comes back
+// at most once per 1024 destroys. A slot whose generation reaches 4095 is
+// retired rather than wrapped, so a stale handle can never resolve to a
+// newer entity; the 2^20 slots run out after about 4 billion destroys.
+struct EntityHandle {
+    static constexpr std::uint32_t kIndexBits = 20;
+    static constexpr std::uint32_t kIndexMask = (1u << kIndexBits) - 1;
+    static constexpr std::uint32_t kGenerationMask = (1u << (32 - kIndexBits)) - 1;
+    
+    std::uint32_t value = 0;
+    
+    EntityHandle() = default;
+    EntityHandle(std::uint32_t index, std::uint32_t generation)
+        : value((generation << kIndexBits) | (index & kIndexMask)) {}
+    
+    std::uint32_t index() const { return value & kIndexMask; }
+    std::uint32_t generation() const { return value >> kIndexBits; }
+    bool isNull() const { return value == 0; }
+    explicit operator bool() const { return value != 0; }
+    
+    bool operator==(EntityHandle other) const { return value == other.value; }
+    bool operator!=(EntityHandle other) const { return value != other.value; }
+};
+
 // ========================
 // Base Component
 // ========================
+// Per-frame hooks a component type actually implements. Every component
+// declares its set as 'static constexpr ComponentCaps kCaps', and the World
+// only dispatches a hook to the types that declare it, so components with
+// nothing to do each frame never cost a virtual call.
+using ComponentCaps = std::uint8_t;
+constexpr ComponentCaps kCapsNone = 0;
+constexpr ComponentCaps kCapsUpdate = 1 << 0;
+constexpr ComponentCaps kCapsDraw = 1 << 1;
+
 class Component {
 public:
     virtual ~Component() = default;
-    virtual void update(float dt) = 0;
-    virtual void draw(SDL_Renderer* r, const View& view) = 0;    
-    GameObject& parent() { return *m_parent; }
-    void setParent(GameObject* p) { m_parent = p; }
+    virtual void update(float dt) {}
+    virtual void draw(SDL_Renderer* r, const View& view) {}
+    GameObject& parent();  // resolved through the World, defined after it
+    EntityHandle parentHandle() const { return m_parent; }
+    void setParent(EntityHandle p) { m_parent = p; }
     
 protected:
-    GameObject* m_parent = nullptr;
+    EntityHandle m_parent;
+};
+
+// ========================
+// Component Type IDs
+// ========================
+// Every component type gets a compile-time index from its position in
+// ComponentTypes. GameObject uses it to keep one slot per type, so lookups
+// are a single indexed load instead of a dynamic_cast walk.
+template<typename... Ts>
+struct TypeList {};
+
+template<typename T, typename List>
+struct TypeIndex;
+
+template<typename T>
+struct TypeIndex<T, TypeList<>> {
+    static_assert(sizeof(T*) == 0, "Component type is not registered in ComponentTypes");
+};
+
+template<typename T, typename... Ts>
+struct TypeIndex<T, TypeList<T, Ts...>> : std::integral_constant<std::size_t, 0> {};
+
+template<typename T, typename U, typename... Ts>
+struct TypeIndex<T, TypeList<U, Ts...>>
+    : std::integral_constant<std::size_t, 1 + TypeIndex<T, TypeList<Ts...>>::value> {};
+
+template<typename List>
+struct TypeCount;
+
+template<typename... Ts>
+struct TypeCount<TypeList<Ts...>> : std::integral_constant<std::size_t, sizeof...(Ts)> {};
+
+// Register new component types here
+using ComponentTypes = TypeList<
+    BodyComponent,
+    SpriteComponent,
+    ControllerComponent,
+    PhysicsComponent,
+    PatrolBehaviorComponent,
+    BounceBehaviorComponent,
+    HorizontalMoveBehaviorComponent,
+    SolidComponent,
+    EnemyComponent,
+    TilingBackgroundComponent,
+    DormantComponent,
+    SleepingComponent
+>;
+
+using ComponentMask = std::uint32_t;
+constexpr std::size_t kComponentTypeCount = TypeCount<ComponentTypes>::value;
+static_assert(kComponentTypeCount <= sizeof(ComponentMask) * 8, "ComponentMask is too small for ComponentTypes");
+
+template<typename T>
+constexpr std::size_t componentTypeId() { return TypeIndex<T, ComponentTypes>::value; }
+
+template<typename T>
+constexpr ComponentMask componentBit() { return ComponentMask(1) << componentTypeId<T>(); }
+
+// Tag components carry no data. An entity's tag lives in its mask bit alone:
+// no column, no pool chunk and no bytes per entity. Test them with has<T>().
+template<typename T>
+constexpr bool isTagComponent() { return std::is_empty_v<T>; }
+
+// Shared stand-in handed out wherever an API expects a T& for a tag
+template<typename T>
+T& tagInstance() {
+    static T tag;
+    return tag;
+}
+
+inline std::size_t lowestSetBit(ComponentMask bits) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, bits);
+    return index;
+#else
+    return static_cast<std::size_t>(__builtin_ctz(bits));
+#endif
+}
+
+inline std::size_t lowestSetBit64(std::uint64_t bits) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, bits);
+    return index;
+#elif defined(_MSC_VER)
+    unsigned long index;
+    if(_BitScanForward(&index, static_cast<unsigned long>(bits))) return index;
+    _BitScanForward(&index, static_cast<unsigned long>(bits >> 32));
+    return index + 32;
+#else
+    return static_cast<std::size_t>(__builtin_ctzll(bits));
+#endif
+}
+
+// Display names, in ComponentTypes order
+constexpr const char* kComponentTypeNames[] = {
+    "Body", "Sprite", "Controller", "Physics", "PatrolBehavior",
+    "BounceBehavior", "HorizontalMoveBehavior", "Solid", "Enemy", "TilingBackground",
+    "Dormant", "Sleeping"
+};
+static_assert(sizeof(kComponentTypeNames) / sizeof(kComponentTypeNames[0]) == kComponentTypeCount,
+              "kComponentTypeNames must list every entry of ComponentTypes");
+
+// Calls fn(static_cast<T*>(nullptr)) once per registered component type
+template<typename List>
+struct TypeListVisitor;
+
+template<typename... Ts>
+struct TypeListVisitor<TypeList<Ts...>> {
+    template<typename Fn>
+    static void visit(Fn&& fn) { (fn(static_cast<Ts*>(nullptr)), ...); }
+};
+
+// ========================
+// Pool Allocators
+// ========================
+struct PoolStats {
+    std::size_t live = 0;       // objects currently constructed
+    std::size_t highWater = 0;  // peak of 'live' since startup
+    std::size_t capacity = 0;   // objects the pool can hold without allocating
+};
+
+// Fixed-size slab allocator. Slots are carved from chunks that never move,
+// so addresses are stable, and destroyed slots go on a free list for reuse.
+// Memory is only requested from the heap when the free list is empty.
+template<typename T, std::size_t ChunkCapacity = 256>
+class ObjectPool {
+public:
+    ObjectPool() = default;
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+    
+    template<typename... Args>
+    T* create(Args&&... args) {
+        if(!m_freeList) grow();
+        Slot* slot = m_freeList;
+        m_freeList = slot->next;
+        T* obj;
+        if constexpr (sizeof...(Args) == 0) {
+            obj = new (slot->storage) T;  // default-init; raw chunks stay uninitialized
+        } else {
+            obj = new (slot->storage) T(std::forward<Args>(args)...);
+        }
+        m_stats.live++;
+        m_stats.highWater = std::max(m_stats.highWater, m_stats.live);
+        return obj;
+    }
+    
+    void destroy(T* obj) {
+        obj->~T();
+        Slot* slot = reinterpret_cast<Slot*>(obj);
+        slot->next = m_freeList;
+        m_freeList = slot;
+        m_stats.live--;
+    }
+    
+    const PoolStats& stats() const { return m_stats; }
+    
+private:
+    union Slot {
+        Slot* next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+    
+    void grow() {
+        m_chunks.push_back(std::make_unique<Slot[]>(ChunkCapacity));
+        Slot* chunk = m_chunks.back().get();
+        for(std::size_t i = ChunkCapacity; i-- > 0;) {
+            chunk[i].next = m_freeList;
+            m_freeList = &chunk[i];
+        }
+        m_stats.capacity += ChunkCapacity;
+    }
+    
+    std::vector<std::unique_ptr<Slot[]>> m_chunks;
+    Slot* m_freeList = nullptr;
+    PoolStats m_stats;
+};
+
+// Per-component-type pool. Archetype columns are built from fixed-size
+// chunks of raw component storage taken from here; a chunk emptied by a
+// despawn goes back on the free list, so steady-state spawning and
+// despawning never touches malloc.
+template<typename T>
+class ComponentPool {
+public:
+    static constexpr std::size_t kChunkCapacity = 64;
+    
+    struct Chunk {
+        alignas(T) unsigned char storage[sizeof(T) * kChunkCapacity];
+        T* data() { return reinterpret_cast<T*>(storage); }
+    };
+    
+    static ComponentPool& getInstance() {
+        static ComponentPool instance;
+        return instance;
+    }
+    
+    Chunk* acquireChunk() { return m_chunks.create(); }
+    void releaseChunk(Chunk* chunk) { m_chunks.destroy(chunk); }
+    
+    void onConstruct() {
+        m_live++;
+        m_highWater = std::max(m_highWater, m_live);
+    }
+    void onDestroy() { m_live--; }
+    
+    PoolStats stats() const {
+        return { m_live, m_highWater, m_chunks.stats().capacity * kChunkCapacity };
+    }
+    
+private:
+    ComponentPool() = default;
+    
+    ObjectPool<Chunk, 16> m_chunks;
+    std::size_t m_live = 0;
+    std::size_t m_highWater = 0;
+};
+
+// ========================
+// Entity Roles
+// ========================
+// Gameplay roles that systems look entities up by. The World keeps a list
+// per role, updated as entities gain roles and are destroyed, so finding the
+// player is a lookup rather than a scan. An entity may hold several roles,
+// and a role may be held by several entities (one player each in co-op).
+enum class EntityRole : std::uint8_t {
+    Player,
+    CameraTarget,
+    Spawner,
+    Checkpoint,
+    Count
+};
+
+constexpr std::size_t kEntityRoleCount = static_cast<std::size_t>(EntityRole::Count);
+
+// Display/XML names, in EntityRole order
+constexpr const char* kEntityRoleNames[] = { "player", "camera_target", "spawner", "checkpoint" };
+static_assert(sizeof(kEntityRoleNames) / sizeof(kEntityRoleNames[0]) == kEntityRoleCount,
+              "kEntityRoleNames must list every EntityRole");
+
+using RoleMask = std::uint8_t;
+
+constexpr RoleMask roleBit(EntityRole role) { return RoleMask(1) << static_cast<std::size_t>(role); }
+
+// ========================
+// Collision Layers
+// ========================
+// Each body sits on one layer and lists the layers it collides with. Two
+// bodies interact only if each one's mask includes the other's layer, so
+// pairs such as platform-platform are never generated by the broadphase.
+enum class CollisionLayer : std::uint8_t {
+    None,     // not collidable
+    Player,
+    Enemy,
+    Solid,
+    Count
 };
 
+constexpr std::size_t kCollisionLayerCount = static_cast<std::size_t>(CollisionLayer::Count);
+
+// XML names, in CollisionLayer order
+constexpr const char* kCollisionLayerNames[] = { "none", "player", "enemy", "solid" };
+static_assert(sizeof(kCollisionLayerNames) / sizeof(kCollisionLayerNames[0]) == kCollisionLayerCount,
+              "kCollisionLayerNames must list every CollisionLayer");
+
+using LayerMask = std::uint16_t;
+
+constexpr LayerMask layerBit(CollisionLayer layer) {
+    return layer == CollisionLayer::None ? 0 : LayerMask(1) << static_cast<std::size_t>(layer);
+}
+
 // ========================
 // GameObject
 // ========================
+class Archetype;
+class World;
+
 class GameObject {
     public:
         template<typename T, typename... Args>
-        T* add(Args&&... args) {
-            auto comp = std::make_unique<T>(std::forward<Args>(args)...);
-            comp->setParent(this);
-            T* ptr = comp.get();
-            components.emplace_back(std::move(comp));
-            return ptr;
-        }
+        T* add(Args&&... args);
     
         template<typename T>
         T* get() {
-            for(auto& c : components) {
-                if(auto ptr = dynamic_cast<T*>(c.get())) {
-                    return ptr;
-                }
-            }
-            return nullptr;
+            static_assert(!isTagComponent<T>(), "Tag components have no data, test them with has<T>()");
+            return static_cast<T*>(m_slots[componentTypeId<T>()]);
         }
     
-        void update(float dt) {
-            for(auto& c : components) {
-                c->update(dt);
-            }
+        template<typename T>
+        bool has() const {
+            return (m_mask & componentBit<T>()) != 0;
         }
     
-        void draw(SDL_Renderer* renderer, const View& view) {
-            for(auto& c : components) {
-                c->draw(renderer, view);
-            }
-        }
+        ComponentMask mask() const { return m_mask; }
+        EntityHandle handle() const { return m_handle; }
+        bool hasRole(EntityRole role) const { return (m_roles & roleBit(role)) != 0; }
+    
+        // Only visit components whose type declares the hook; defined once
+        // every component type is complete
+        void update(float dt);
+        void draw(SDL_Renderer* renderer, const View& view);
     
         bool isActive = true;
     
     private:
-        std::vector<std::unique_ptr<Component>> components;
+        friend class World;
+    
+        // Components are owned by the World's archetype columns; the slots
+        // point into them and are patched when the entity's row moves.
+        std::array<Component*, kComponentTypeCount> m_slots{};
+        ComponentMask m_mask = 0;
+        RoleMask m_roles = 0;
+        EntityHandle m_handle;
+        Archetype* m_archetype = nullptr;
+        std::size_t m_row = 0;
+        std::size_t m_entityIndex = 0;  // position in the World's entity list
     };
 
 // ========================
-// Required Components
-// ========================
-// ========================
-// Tiling Background Component
+// World (Archetype Storage)
 // ========================
-class TilingBackgroundComponent : public Component {
-    public:
-        TilingBackgroundComponent(const std::string& textureKey, float scrollSpeedX = 0.0f, float scrollSpeedY = 0.0f) 
-            : m_textureKey(textureKey), m_scrollSpeedX(scrollSpeedX), m_scrollSpeedY(scrollSpeedY), m_texture(nullptr) {}
-        
-        void update(float dt) override {
-            // Update scroll offsets for animated backgrounds
-            m_scrollOffsetX += m_scrollSpeedX * dt;
-            m_scrollOffsetY += m_scrollSpeedY * dt;
-            
-            // Wrap offsets to prevent overflow
-            if (m_scrollOffsetX >= m_textureWidth) m_scrollOffsetX -= m_textureWidth;
-            if (m_scrollOffsetX <= -m_textureWidth) m_scrollOffsetX += m_textureWidth;
-            if (m_scrollOffsetY >= m_textureHeight) m_scrollOffsetY -= m_textureHeight;
-            if (m_scrollOffsetY <= -m_textureHeight) m_scrollOffsetY += m_textureHeight;
+// Each component type is stored in its own contiguous column, and entities
+// with the same set of component types (an archetype) share one row index
+// across those columns. A pass over all BodyComponents therefore walks
+// arrays instead of chasing a pointer per entity. GameObject stays the
+// public facade and keeps pointers into the columns in its slot table.
+class ComponentColumn {
+public:
+    virtual ~ComponentColumn() = default;
+    virtual std::unique_ptr<ComponentColumn> cloneEmpty() const = 0;
+    virtual Component* at(std::size_t row) = 0;
+    virtual std::size_t size() const = 0;
+    // Append row 'row' of another column of the same type
+    virtual void moveFrom(ComponentColumn& other, std::size_t row) = 0;
+    virtual void swapRemove(std::size_t row) = 0;
+    // Append 'count' copies of row 'row' of another column of the same type
+    virtual void appendCopies(ComponentColumn& source, std::size_t row, std::size_t count) = 0;
+    virtual void updateAll(float dt, const std::vector<GameObject*>& owners) = 0;
+};
+
+// A column is a list of pooled chunks, so rows never relocate when it grows
+template<typename T>
+class TypedColumn : public ComponentColumn {
+public:
+    using Pool = ComponentPool<T>;
+    static constexpr std::size_t kChunkCapacity = Pool::kChunkCapacity;
+    
+    TypedColumn() = default;
+    TypedColumn(const TypedColumn&) = delete;
+    TypedColumn& operator=(const TypedColumn&) = delete;
+    
+    ~TypedColumn() override {
+        while(m_size > 0) popBack();
+    }
+    
+    std::unique_ptr<ComponentColumn> cloneEmpty() const override {
+        return std::make_unique<TypedColumn<T>>();
+    }
+    
+    Component* at(std::size_t row) override { return &(*this)[row]; }
+    std::size_t size() const override { return m_size; }
+    
+    void moveFrom(ComponentColumn& other, std::size_t row) override {
+        emplace(std::move(static_cast<TypedColumn<T>&>(other)[row]));
+    }
+    
+    void swapRemove(std::size_t row) override {
+        if(row + 1 != m_size) {
+            (*this)[row] = std::move((*this)[m_size - 1]);
         }
-        
-        void draw(SDL_Renderer* renderer, const View& view) override {  // ADD 'override' here
-            if (!m_texture) {
-                m_texture = TextureManager::getInstance().getTexture(m_textureKey);
-                if (!m_texture) {
-                    SDL_SetRenderDrawColor(renderer, 135, 206, 235, 255);
-                    SDL_RenderClear(renderer);
-                    return;
-                }
-                
-                // Automatically get the actual texture dimensions
-                SDL_QueryTexture(m_texture, NULL, NULL, &m_textureWidth, &m_textureHeight);
-                
-                std::cout << "Tiling background loaded: " << m_textureKey 
-                          << " (" << m_textureWidth << "x" << m_textureHeight << ")" << std::endl;
-            }
-            
-            // Get screen dimensions
-            int screenWidth, screenHeight;
-            SDL_GetRendererOutputSize(renderer, &screenWidth, &screenHeight);
-            
-            // Calculate starting positions for tiling
-            int startX = static_cast<int>(-m_scrollOffsetX);
-            int startY = static_cast<int>(-m_scrollOffsetY);
-            
-            // Ensure we cover the entire screen with some margin
-            int tilesX = (screenWidth / m_textureWidth) + 2;
-            int tilesY = (screenHeight / m_textureHeight) + 2;
-            
-            // Draw tiled background
-            for (int y = 0; y < tilesY; y++) {
-                for (int x = 0; x < tilesX; x++) {
-                    SDL_Rect destRect = {
-                        startX + (x * m_textureWidth),
-                        startY + (y * m_textureHeight),
-                        m_textureWidth,
-                        m_textureHeight
-                    };
-                    SDL_RenderCopy(renderer, m_texture, NULL, &destRect);
+        popBack();
+    }
+    
+    void appendCopies(ComponentColumn& source, std::size_t row, std::size_t count) override {
+        const T& prototype = static_cast<TypedColumn<T>&>(source)[row];
+        m_chunks.reserve((m_size + count + kChunkCapacity - 1) / kChunkCapacity);
+        for(std::size_t i = 0; i < count; ++i) {
+            emplace(prototype);
+        }
+    }
+    
+    void updateAll(float dt, const std::vector<GameObject*>& owners) override {
+        std::size_t row = 0;
+        for(auto* chunk : m_chunks) {
+            T* items = chunk->data();
+            const std::size_t count = std::min(kChunkCapacity, m_size - row);
+            for(std::size_t i = 0; i < count; ++i, ++row) {
+                if(owners[row]->isActive) {
+                    items[i].T::update(dt);  // exact type is known, skip the vtable
                 }
             }
-            
-            // Debug info (optional)
-            static int debugCounter = 0;
-            if (debugCounter++ % 300 == 0) {
-                std::cout << "Drawing tiling background: " << tilesX << "x" << tilesY << " tiles" 
-                          << " at offset (" << m_scrollOffsetX << "," << m_scrollOffsetY << ")" << std::endl;
-            }
         }
-        
-        // Method to change scroll speed dynamically
-        void setScrollSpeed(float speedX, float speedY) {
-            m_scrollSpeedX = speedX;
-            m_scrollSpeedY = speedY;
+    }
+    
+    template<typename... Args>
+    T& emplace(Args&&... args) {
+        if(m_size == m_chunks.size() * kChunkCapacity) {
+            m_chunks.push_back(Pool::getInstance().acquireChunk());
         }
-        
-    private:
-        std::string m_textureKey;
-        SDL_Texture* m_texture;
-        float m_scrollSpeedX;
-        float m_scrollSpeedY;
-        float m_scrollOffsetX = 0.0f;
-        float m_scrollOffsetY = 0.0f;
-        int m_textureWidth = 0;
-        int m_textureHeight = 0;
-    };
-// BodyComponent
-class BodyComponent : public Component {
-public:
-    float x, y, width, height;
-    float velocityX = 0, velocityY = 0;
-    float angle = 0;
-    float prevX = 0, prevY = 0;
+        T* slot = m_chunks.back()->data() + (m_size % kChunkCapacity);
+        new (slot) T(std::forward<Args>(args)...);
+        m_size++;
+        Pool::getInstance().onConstruct();
+        return *slot;
+    }
     
-    BodyComponent(float x, float y, float w, float h) : x(x), y(y), width(w), height(h), prevX(x), prevY(y) {}
+    T& operator[](std::size_t row) {
+        return m_chunks[row / kChunkCapacity]->data()[row % kChunkCapacity];
+    }
     
-    void update(float dt) override {
-        prevX = x;
-        prevY = y;
-        
-        x += velocityX * dt;
-        y += velocityY * dt;
+private:
+    void popBack() {
+        (*this)[m_size - 1].~T();
+        m_size--;
+        Pool::getInstance().onDestroy();
+        if(m_size % kChunkCapacity == 0) {
+            Pool::getInstance().releaseChunk(m_chunks.back());
+            m_chunks.pop_back();
+        }
     }
     
-    void draw(SDL_Renderer* renderer, const View& view) override {}
-
-    float getVelocityX() const { return x - prevX; }
-    float getVelocityY() const { return y - prevY; }
+    std::vector<typename Pool::Chunk*> m_chunks;
+    std::size_t m_size = 0;
 };
 
-// PhysicsComponent - Handles gravity and ground collision for any object
-class PhysicsComponent : public Component {
+class Archetype {
 public:
-    void update(float dt) override {
-        auto body = parent().get<BodyComponent>();
-        if(!body) return;
-        
-        // Apply gravity
-        body->velocityY += gravity * dt;
-        body->y += body->velocityY * dt;
+    explicit Archetype(ComponentMask mask) : m_mask(mask) {}
+    
+    ComponentMask mask() const { return m_mask; }
+    std::size_t size() const { return m_entities.size(); }
+    const std::vector<GameObject*>& entities() const { return m_entities; }
+    
+    template<typename T>
+    TypedColumn<T>& column() {
+        static_assert(!isTagComponent<T>(), "Tag components have no column");
+        return static_cast<TypedColumn<T>&>(*m_columns[componentTypeId<T>()]);
+    }
+    
+    // Row 'row' of T's column, or the shared tag instance for tag types
+    template<typename T>
+    T& component(std::size_t row) {
+        if constexpr (isTagComponent<T>()) {
+            return tagInstance<T>();
+        } else {
+            return column<T>()[row];
+        }
     }
     
-void draw(SDL_Renderer* renderer, const View& view) override {}    
 private:
-    float gravity = 800.0f;
+    friend class World;
+    
+    ComponentMask m_mask;
+    std::vector<GameObject*> m_entities;
+    std::array<std::unique_ptr<ComponentColumn>, kComponentTypeCount> m_columns;
 };
 
-// SolidComponent - Marks an object as solid for collision
-class SolidComponent : public Component {
-public:
-    void update(float dt) override {}
-    void draw(SDL_Renderer* renderer, const View& view) override {}    
-    bool isSolid = true;
+// Cached result of a component query: every archetype that has all of
+// 'include' and none of 'exclude'. Archetypes are only ever appended, so
+// the cache is kept current by checking each new archetype once, and an
+// entity gaining or losing a component just moves between archetypes.
+struct QueryCache {
+    ComponentMask include = 0;
+    ComponentMask exclude = 0;
+    std::vector<Archetype*> archetypes;
+    
+    bool matches(ComponentMask mask) const {
+        return (mask & include) == include && (mask & exclude) == 0;
+    }
 };
 
-// EnemyComponent - Marks an object as an enemy that can kill the player
-class EnemyComponent : public Component {
-public:
-    void update(float dt) override {}
-    void draw(SDL_Renderer* renderer, const View& view) override {}    
-    bool isEnemy = true;
-};
+template<typename... Ts>
+class EntityView;
 
-// SpriteComponent with texture and sprite sheet support
-// SpriteComponent with texture and sprite sheet support
-class SpriteComponent : public Component {
-    public:
-        SpriteComponent(const std::string& textureKey = "", SDL_Color color = {255, 255, 255, 255}) 
-            : m_textureKey(textureKey), m_color(color), m_texture(nullptr) {}
-        
-        void update(float dt) override {
-            // Update animation frame if needed
-            if(m_animated) {
-                m_animationTimer += dt;
-                if(m_animationTimer >= m_frameDuration) {
-                    m_animationTimer = 0;
-                    m_currentFrame = (m_currentFrame + 1) % m_totalFrames;
-                }
+// ========================
+// Prefabs
+// ========================
+// An entity template built once: a single fully configured row of each of
+// its component types. World::instantiate() copy-constructs that row straight
+// into the matching archetype, so spawning many copies skips all per-instance
+// parsing and setup. Offers the same add/get/has as GameObject.
+class Prefab {
+public:
+    Prefab() = default;
+    Prefab(const Prefab&) = delete;
+    Prefab& operator=(const Prefab&) = delete;
+    
+    template<typename T, typename... Args>
+    T* add(Args&&... args) {
+        if constexpr (isTagComponent<T>()) {
+            static_assert(sizeof...(Args) == 0, "Tag components take no constructor arguments");
+            m_mask |= componentBit<T>();
+            return &tagInstance<T>();
+        } else {
+            auto& column = m_columns[componentTypeId<T>()];
+            if(!column) {
+                auto typed = std::make_unique<TypedColumn<T>>();
+                typed->emplace(std::forward<Args>(args)...);
+                column = std::move(typed);
+                m_mask |= componentBit<T>();
+            }
+            return get<T>();
+        }
+    }
+    
+    template<typename T>
+    T* get() {
+        static_assert(!isTagComponent<T>(), "Tag components have no data, test them with has<T>()");
+        auto& column = m_columns[componentTypeId<T>()];
+        return column ? &static_cast<TypedColumn<T>&>(*column)[0] : nullptr;
+    }
+    
+    template<typename T>
+    bool has() const {
+        return (m_mask & componentBit<T>()) != 0;
+    }
+    
+    ComponentMask mask() const { return m_mask; }
+    
+    // Roles every instance is given, e.g. Player for a player prefab
+    void setRoles(RoleMask roles) { m_roles = roles; }
+    RoleMask roles() const { return m_roles; }
+    
+private:
+    friend class World;
+    
+    ComponentMask m_mask = 0;
+    RoleMask m_roles = 0;
+    std::array<std::unique_ptr<ComponentColumn>, kComponentTypeCount> m_columns;
+};
+
+// ========================
+// Command Buffer
+// ========================
+// Structural changes (spawn, destroy, add/remove component) are not safe
+// while systems are iterating the World. Systems record them here instead,
+// from any thread, and World::flushCommands() applies the whole batch at
+// the end of the frame. Commands are placement-constructed in fixed-size
+// blocks that are kept and reused, so recording does not allocate once the
+// buffer has warmed up.
+class CommandBuffer {
+public:
+    // Stand-in for an entity spawned by this buffer before it exists
+    struct PendingEntity {
+        std::uint32_t index;
+    };
+    
+    CommandBuffer() = default;
+    CommandBuffer(const CommandBuffer&) = delete;
+    CommandBuffer& operator=(const CommandBuffer&) = delete;
+    
+    ~CommandBuffer() { reset(); }
+    
+    PendingEntity spawn();
+    void destroy(EntityHandle handle);
+    
+    template<typename T, typename... Args>
+    void addComponent(EntityHandle target, Args&&... args);
+    
+    template<typename T, typename... Args>
+    void addComponent(PendingEntity target, Args&&... args);
+    
+    template<typename T>
+    void removeComponent(EntityHandle target);
+    
+    bool empty() const { return m_commands.empty(); }
+    
+    // Main thread only, with no systems running
+    void apply(World& world);
+    
+    // Drops everything recorded without applying it, e.g. when the World is
+    // cleared and the handles the commands target are about to be released
+    void discard() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        reset();
+    }
+    
+private:
+    // Either a live handle or an index into this frame's spawns
+    struct Target {
+        EntityHandle handle;
+        std::uint32_t pending = UINT32_MAX;
+    };
+    
+    struct Command {
+        virtual ~Command() = default;
+        virtual void apply(World& world, CommandBuffer& buffer) = 0;
+    };
+    
+    template<typename T, typename... Args>
+    struct AddComponentCommand;
+    
+    template<typename T>
+    struct RemoveComponentCommand;
+    
+    struct SpawnCommand;
+    
+    static constexpr std::size_t kBlockSize = 16 * 1024;
+    
+    template<typename C, typename... Args>
+    void record(Args&&... args) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        void* memory = allocate(sizeof(C), alignof(C));
+        m_commands.push_back(new (memory) C(std::forward<Args>(args)...));
+    }
+    
+    void* allocate(std::size_t size, std::size_t align) {
+        for(;;) {
+            if(m_block < m_blocks.size() && m_blocks[m_block].size >= size) {
+                Block& block = m_blocks[m_block];
+                std::size_t offset = (m_offset + align - 1) & ~(align - 1);
+                if(offset + size <= block.size) {
+                    m_offset = offset + size;
+                    return block.memory.get() + offset;
+                }
+                m_block++;
+                m_offset = 0;
+                continue;
+            }
+            // Oversized commands get a dedicated block, kept for reuse like the rest
+            std::size_t blockSize = std::max(kBlockSize, size + align);
+            Block block{std::unique_ptr<unsigned char[]>(new unsigned char[blockSize]), blockSize};
+            m_blocks.insert(m_blocks.begin() + std::min(m_block, m_blocks.size()), std::move(block));
+            m_offset = 0;
+        }
+    }
+    
+    GameObject* resolve(World& world, const Target& target) const;
+    
+    void reset() {
+        for(Command* command : m_commands) {
+            command->~Command();
+        }
+        m_commands.clear();
+        m_spawned.clear();
+        m_destroyed.clear();
+        m_pendingCount = 0;
+        m_block = 0;
+        m_offset = 0;
+    }
+    
+    struct Block {
+        std::unique_ptr<unsigned char[]> memory;
+        std::size_t size;
+    };
+    
+    std::mutex m_mutex;
+    std::vector<Block> m_blocks;
+    std::size_t m_block = 0;
+    std::size_t m_offset = 0;
+    std::vector<Command*> m_commands;
+    std::vector<EntityHandle> m_spawned;
+    std::vector<EntityHandle> m_destroyed;
+    std::uint32_t m_pendingCount = 0;
+};
+
+// Level geometry: solid bodies with nothing that can move them. These go in
+// the StaticBvh once; everything else is rebuilt into a Broadphase per frame.
+inline bool isStaticBody(ComponentMask mask) {
+    constexpr ComponentMask movers = componentBit<ControllerComponent>() | componentBit<PhysicsComponent>()
+                                   | componentBit<PatrolBehaviorComponent>() | componentBit<BounceBehaviorComponent>()
+                                   | componentBit<HorizontalMoveBehaviorComponent>();
+    return (mask & componentBit<SolidComponent>()) && !(mask & movers);
+}
+
+class World {
+public:
+    static World& getInstance() {
+        static World instance;
+        return instance;
+    }
+    
+    GameObject* createEntity() {
+        m_structureVersion++;
+        GameObject* obj = m_objectPool.create();
+        obj->m_handle = allocateHandle(obj);
+        obj->m_entityIndex = m_entities.size();
+        m_entities.push_back(obj);
+        Archetype& root = findOrCreateArchetype(0, nullptr);
+        obj->m_archetype = &root;
+        obj->m_row = root.m_entities.size();
+        root.m_entities.push_back(obj);
+        return obj;
+    }
+    
+    void destroyEntity(GameObject* obj) {
+        if(obj->m_roles) clearRoles(*obj);
+        removeRow(*obj->m_archetype, obj->m_row);
+        unlistEntity(*obj);
+        releaseHandle(obj->m_handle);
+        m_objectPool.destroy(obj);
+    }
+    
+    void destroyEntity(EntityHandle handle) {
+        if(GameObject* obj = resolve(handle)) {
+            destroyEntity(obj);
+        }
+    }
+    
+    // O(1): one bounds check, one generation compare, one load
+    GameObject* resolve(EntityHandle handle) const {
+        const std::uint32_t index = handle.index();
+        if(index >= m_slots.size()) return nullptr;
+        const EntitySlot& slot = m_slots[index];
+        return slot.generation == handle.generation() ? slot.object : nullptr;
+    }
+    
+    bool isValid(EntityHandle handle) const { return resolve(handle) != nullptr; }
+    
+    void clear() {
+        // Columns hand their chunks back to the component pools. Query
+        // caches survive so views held by systems stay usable. Prefabs go
+        // too, as they may point at textures that are about to be unloaded.
+        // Commands still pending were recorded against the old level and are dropped.
+        m_structureVersion++;
+        m_commands.discard();
+        m_prefabs.clear();
+        for(auto& holders : m_roles) {
+            holders.clear();
+        }
+        for(auto& entry : m_queries) {
+            entry.second->archetypes.clear();
+        }
+        m_archetypeIndex.clear();
+        m_archetypes.clear();
+        for(GameObject* obj : m_entities) {
+            releaseHandle(obj->m_handle);
+            m_objectPool.destroy(obj);
+        }
+        m_entities.clear();
+    }
+    
+    template<typename T, typename... Args>
+    T* addComponent(GameObject& obj, Args&&... args);
+    
+    template<typename T>
+    void removeComponent(GameObject& obj);
+    
+    void assignRole(GameObject& obj, EntityRole role) {
+        if(obj.hasRole(role)) return;
+        obj.m_roles |= roleBit(role);
+        m_roles[static_cast<std::size_t>(role)].push_back(&obj);
+    }
+    
+    void removeRole(GameObject& obj, EntityRole role) {
+        if(!obj.hasRole(role)) return;
+        obj.m_roles &= ~roleBit(role);
+        auto& holders = m_roles[static_cast<std::size_t>(role)];
+        holders.erase(std::find(holders.begin(), holders.end(), &obj));
+    }
+    
+    // Every entity holding 'role', in the order they received it
+    const std::vector<GameObject*>& withRole(EntityRole role) const {
+        return m_roles[static_cast<std::size_t>(role)];
+    }
+    
+    GameObject* firstWithRole(EntityRole role) const {
+        const auto& holders = withRole(role);
+        return holders.empty() ? nullptr : holders.front();
+    }
+    
+    // Named prefabs shared by every instance; registering a name again replaces it
+    Prefab& registerPrefab(const std::string& name, std::unique_ptr<Prefab> prefab) {
+        auto& slot = m_prefabs[name];
+        slot = std::move(prefab);
+        return *slot;
+    }
+    
+    Prefab* findPrefab(const std::string& name) {
+        auto it = m_prefabs.find(name);
+        return it != m_prefabs.end() ? it->second.get() : nullptr;
+    }
+    
+    // Spawns 'count' copies of a prefab in one batch, directly in their final
+    // archetype, each with the prefab's roles. overrides(i, obj) then runs on
+    // each new entity to set whatever differs per instance, such as its position.
+    std::vector<GameObject*> instantiate(Prefab& prefab, std::size_t count,
+                                         const std::function<void(std::size_t, GameObject&)>& overrides = nullptr) {
+        std::vector<GameObject*> spawned;
+        if(count == 0) return spawned;
+        spawned.reserve(count);
+        m_structureVersion++;
+        if(isStaticBody(prefab.m_mask)) m_staticGeometryVersion++;
+        
+        Archetype& arch = findOrCreateArchetype(prefab.m_mask, nullptr);
+        const std::size_t firstRow = arch.m_entities.size();
+        for(std::size_t id = 0; id < kComponentTypeCount; ++id) {
+            if(!prefab.m_columns[id]) continue;
+            if(!arch.m_columns[id]) {
+                arch.m_columns[id] = prefab.m_columns[id]->cloneEmpty();
+            }
+            arch.m_columns[id]->appendCopies(*prefab.m_columns[id], 0, count);
+        }
+        
+        arch.m_entities.reserve(firstRow + count);
+        m_entities.reserve(m_entities.size() + count);
+        for(std::size_t i = 0; i < count; ++i) {
+            GameObject* obj = m_objectPool.create();
+            obj->m_handle = allocateHandle(obj);
+            obj->m_archetype = &arch;
+            obj->m_row = firstRow + i;
+            obj->m_mask = prefab.m_mask;
+            for(std::size_t id = 0; id < kComponentTypeCount; ++id) {
+                if(arch.m_columns[id]) {
+                    Component* comp = arch.m_columns[id]->at(obj->m_row);
+                    comp->setParent(obj->m_handle);
+                    obj->m_slots[id] = comp;
+                }
+            }
+            arch.m_entities.push_back(obj);
+            obj->m_entityIndex = m_entities.size();
+            m_entities.push_back(obj);
+            spawned.push_back(obj);
+        }
+        
+        for(std::size_t role = 0; role < kEntityRoleCount; ++role) {
+            if(!(prefab.m_roles & roleBit(static_cast<EntityRole>(role)))) continue;
+            for(GameObject* obj : spawned) assignRole(*obj, static_cast<EntityRole>(role));
+        }
+        
+        if(overrides) {
+            for(std::size_t i = 0; i < count; ++i) {
+                overrides(i, *spawned[i]);
+            }
+        }
+        return spawned;
+    }
+    
+    // Destroys a batch of entities, releasing their GameObjects once all are
+    // unlinked. Stale or repeated handles are skipped.
+    void destroyEntities(const std::vector<EntityHandle>& handles) {
+        m_dying.clear();
+        for(EntityHandle handle : handles) {
+            GameObject* obj = resolve(handle);
+            if(!obj) continue;
+            if(obj->m_roles) clearRoles(*obj);
+            removeRow(*obj->m_archetype, obj->m_row);
+            unlistEntity(*obj);
+            releaseHandle(obj->m_handle);
+            obj->m_archetype = nullptr;
+            m_dying.push_back(obj);
+        }
+        for(GameObject* obj : m_dying) {
+            m_objectPool.destroy(obj);
+        }
+    }
+    
+    // Deferred structural changes recorded during the frame
+    CommandBuffer& commands() { return m_commands; }
+    void flushCommands();
+    
+    // Cached view over every entity that has all of Ts
+    template<typename... Ts>
+    EntityView<Ts...> view();
+    
+    // Calls fn(GameObject&, Ts&...) for every entity that has all of Ts
+    template<typename... Ts, typename Fn>
+    void each(Fn&& fn);
+    
+    QueryCache& query(ComponentMask include, ComponentMask exclude) {
+        std::lock_guard<std::mutex> lock(m_queryMutex);
+        const std::uint64_t key = (std::uint64_t(include) << 32) | exclude;
+        auto it = m_queries.find(key);
+        if(it != m_queries.end()) {
+            return *it->second;
+        }
+        
+        auto cache = std::make_unique<QueryCache>();
+        cache->include = include;
+        cache->exclude = exclude;
+        for(auto& arch : m_archetypes) {
+            if(cache->matches(arch->m_mask)) {
+                cache->archetypes.push_back(arch.get());
+            }
+        }
+        QueryCache& result = *cache;
+        m_queries.emplace(key, std::move(cache));
+        return result;
+    }
+    
+    // Runs update() on every component of the given types, one type at a time.
+    // Only reads the archetype list, so systems touching disjoint component
+    // types may call this concurrently.
+    template<typename... Ts>
+    void updateComponents(float dt) {
+        static_assert(((Ts::kCaps & kCapsUpdate) && ...), "updateComponents needs types that declare kCapsUpdate");
+        (updateColumns(componentTypeId<Ts>(), dt), ...);
+    }
+    
+    const std::vector<GameObject*>& entities() const { return m_entities; }
+    std::size_t archetypeCount() const { return m_archetypes.size(); }
+    
+    // Bumped whenever entities are created or destroyed or their components
+    // may have moved, so caches of component pointers know to re-resolve
+    // their handles and caches of entities know to look for new ones
+    std::uint64_t structureVersion() const { return m_structureVersion; }
+    
+    // Bumped whenever an entity becomes level geometry (see isStaticBody),
+    // so the StaticBvh knows to rebuild without scanning for new members
+    std::uint64_t staticGeometryVersion() const { return m_staticGeometryVersion; }
+    const PoolStats& entityPoolStats() const { return m_objectPool.stats(); }
+    
+private:
+    World();  // defined once every component type is complete
+    
+    Archetype& findOrCreateArchetype(ComponentMask mask, const Archetype* source) {
+        auto it = m_archetypeIndex.find(mask);
+        if(it != m_archetypeIndex.end()) {
+            return *it->second;
+        }
+        
+        m_archetypes.push_back(std::make_unique<Archetype>(mask));
+        Archetype* arch = m_archetypes.back().get();
+        if(source) {
+            for(std::size_t id = 0; id < kComponentTypeCount; ++id) {
+                if(source->m_columns[id] && (mask & (ComponentMask(1) << id))) {
+                    arch->m_columns[id] = source->m_columns[id]->cloneEmpty();
+                }
+            }
+        }
+        m_archetypeIndex[mask] = arch;
+        
+        std::lock_guard<std::mutex> lock(m_queryMutex);
+        for(auto& entry : m_queries) {
+            if(entry.second->matches(mask)) {
+                entry.second->archetypes.push_back(arch);
+            }
+        }
+        return *arch;
+    }
+    
+    // Dormant archetypes are skipped whole, so their rows are never touched.
+    // Sleeping ones only skip integration; their sprites still animate.
+    void updateColumns(std::size_t typeId, float dt) {
+        constexpr ComponentMask integration = componentBit<BodyComponent>() | componentBit<PhysicsComponent>();
+        const ComponentMask bit = ComponentMask(1) << typeId;
+        const ComponentMask frozen = (bit & integration)
+            ? componentBit<DormantComponent>() | componentBit<SleepingComponent>()
+            : componentBit<DormantComponent>();
+        for(auto& arch : m_archetypes) {
+            if((arch->m_mask & bit) && !(arch->m_mask & frozen)) {
+                arch->m_columns[typeId]->updateAll(dt, arch->m_entities);
+            }
+        }
+    }
+    
+    struct EntitySlot {
+        GameObject* object = nullptr;
+        std::uint32_t generation = 1;  // generation 0 is never issued, so handle 0 is null
+        std::uint32_t nextFree = 0;
+    };
+    
+    // Freed slots are held back until this many are waiting (see EntityHandle)
+    static constexpr std::uint32_t kMinFreeSlots = 1024;
+    
+    EntityHandle allocateHandle(GameObject* obj) {
+        std::uint32_t index;
+        if(m_freeSlotCount > kMinFreeSlots) {
+            index = m_firstFreeSlot;
+            m_firstFreeSlot = m_slots[index].nextFree;
+            m_freeSlotCount--;
+        } else {
+            index = static_cast<std::uint32_t>(m_slots.size());
+            if(index > EntityHandle::kIndexMask) {
+                std::cerr << "ERROR: Entity slot map exhausted" << std::endl;
+                std::abort();
+            }
+            m_slots.emplace_back();
+        }
+        m_slots[index].object = obj;
+        return EntityHandle(index, m_slots[index].generation);
+    }
+    
+    void releaseHandle(EntityHandle handle) {
+        EntitySlot& slot = m_slots[handle.index()];
+        slot.object = nullptr;
+        if(slot.generation == EntityHandle::kGenerationMask) return;  // retired: it would wrap
+        slot.generation++;
+        
+        // Queued at the back, so the longest-freed slot is reused first
+        if(m_freeSlotCount == 0) {
+            m_firstFreeSlot = handle.index();
+        } else {
+            m_slots[m_lastFreeSlot].nextFree = handle.index();
+        }
+        m_lastFreeSlot = handle.index();
+        m_freeSlotCount++;
+    }
+    
+    // Moves obj into 'to', carrying across the components both archetypes
+    // share. Components 'to' lacks are destroyed; a column 'to' has but the
+    // old archetype lacks is left one row short for the caller to fill.
+    void migrate(GameObject& obj, Archetype& to) {
+        m_structureVersion++;
+        Archetype& from = *obj.m_archetype;
+        if(isStaticBody(to.m_mask) && !isStaticBody(from.m_mask)) m_staticGeometryVersion++;
+        const std::size_t oldRow = obj.m_row;
+        const ComponentMask shared = from.m_mask & to.m_mask;
+        
+        for(std::size_t id = 0; id < kComponentTypeCount; ++id) {
+            if((shared & (ComponentMask(1) << id)) && to.m_columns[id]) {
+                to.m_columns[id]->moveFrom(*from.m_columns[id], oldRow);
+            }
+        }
+        to.m_entities.push_back(&obj);
+        
+        obj.m_archetype = &to;
+        obj.m_row = to.m_entities.size() - 1;
+        obj.m_mask = to.m_mask;
+        removeRow(from, oldRow);
+        
+        // Pooled chunks never relocate, so only this entity's slots change.
+        // Tags have no column and keep a null slot.
+        for(std::size_t id = 0; id < kComponentTypeCount; ++id) {
+            const bool kept = (shared & (ComponentMask(1) << id)) && to.m_columns[id];
+            obj.m_slots[id] = kept ? to.m_columns[id]->at(obj.m_row) : nullptr;
+        }
+    }
+    
+    void clearRoles(GameObject& obj) {
+        for(std::size_t role = 0; role < kEntityRoleCount; ++role) {
+            removeRole(obj, static_cast<EntityRole>(role));
+        }
+    }
+    
+    // Swap-removes obj from the entity list, as removeRow does for archetype rows
+    void unlistEntity(GameObject& obj) {
+        GameObject* last = m_entities.back();
+        m_entities[obj.m_entityIndex] = last;
+        last->m_entityIndex = obj.m_entityIndex;
+        m_entities.pop_back();
+    }
+    
+    // Swap-removes a row from every column and patches the entity that moved into it
+    void removeRow(Archetype& arch, std::size_t row) {
+        m_structureVersion++;
+        for(auto& column : arch.m_columns) {
+            if(column) column->swapRemove(row);
+        }
+        
+        GameObject* moved = arch.m_entities.back();
+        arch.m_entities[row] = moved;
+        arch.m_entities.pop_back();
+        
+        if(moved->m_archetype == &arch && row < arch.m_entities.size()) {
+            moved->m_row = row;
+            for(std::size_t id = 0; id < kComponentTypeCount; ++id) {
+                if(arch.m_columns[id]) {
+                    moved->m_slots[id] = arch.m_columns[id]->at(row);
+                }
+            }
+        }
+    }
+    
+    std::vector<std::unique_ptr<Archetype>> m_archetypes;
+    std::unordered_map<ComponentMask, Archetype*> m_archetypeIndex;
+    std::unordered_map<std::uint64_t, std::unique_ptr<QueryCache>> m_queries;
+    std::unordered_map<std::string, std::unique_ptr<Prefab>> m_prefabs;
+    std::array<std::vector<GameObject*>, kEntityRoleCount> m_roles;
+    std::mutex m_queryMutex;
+    std::vector<GameObject*> m_entities;
+    std::vector<GameObject*> m_dying;
+    ObjectPool<GameObject> m_objectPool;
+    CommandBuffer m_commands;
+    std::vector<EntitySlot> m_slots;
+    std::uint32_t m_firstFreeSlot = 0;
+    std::uint32_t m_lastFreeSlot = 0;
+    std::uint32_t m_freeSlotCount = 0;
+    std::uint64_t m_structureVersion = 0;
+    std::uint64_t m_staticGeometryVersion = 0;
+};
+
+template<typename T, typename... Args>
+T* World::addComponent(GameObject& obj, Args&&... args) {
+    if constexpr (isTagComponent<T>()) {
+        // Setting the mask bit is the whole component: just change archetype
+        static_assert(sizeof...(Args) == 0, "Tag components take no constructor arguments");
+        if(!obj.has<T>()) {
+            migrate(obj, findOrCreateArchetype(obj.m_mask | componentBit<T>(), obj.m_archetype));
+        }
+        return &tagInstance<T>();
+    } else {
+        // One component per type; a second add keeps the first, matching the old get<T>()
+        if(obj.has<T>()) {
+            return obj.get<T>();
+        }
+    
+        const std::size_t typeId = componentTypeId<T>();
+        Archetype& to = findOrCreateArchetype(obj.m_mask | componentBit<T>(), obj.m_archetype);
+        if(!to.m_columns[typeId]) {
+            to.m_columns[typeId] = std::make_unique<TypedColumn<T>>();
+        }
+    
+        // Move the existing components across, then construct the new one in the same row
+        migrate(obj, to);
+        T& comp = static_cast<TypedColumn<T>&>(*to.m_columns[typeId]).emplace(std::forward<Args>(args)...);
+        comp.setParent(obj.m_handle);
+        obj.m_slots[typeId] = &comp;
+        return &comp;
+    }
+}
+
+template<typename T>
+void World::removeComponent(GameObject& obj) {
+    if(!obj.has<T>()) return;
+    migrate(obj, findOrCreateArchetype(obj.m_mask & ~componentBit<T>(), obj.m_archetype));
+}
+
+struct CommandBuffer::SpawnCommand : CommandBuffer::Command {
+    explicit SpawnCommand(std::uint32_t index) : index(index) {}
+    
+    void apply(World& world, CommandBuffer& buffer) override {
+        buffer.m_spawned[index] = world.createEntity()->handle();
+    }
+    
+    std::uint32_t index;
+};
+
+template<typename T, typename... Args>
+struct CommandBuffer::AddComponentCommand : CommandBuffer::Command {
+    template<typename... CtorArgs>
+    explicit AddComponentCommand(Target target, CtorArgs&&... args)
+        : target(target), args(std::forward<CtorArgs>(args)...) {}
+    
+    void apply(World& world, CommandBuffer& buffer) override {
+        GameObject* obj = buffer.resolve(world, target);
+        if(!obj) return;
+        std::apply([&](auto&... unpacked) { world.addComponent<T>(*obj, std::move(unpacked)...); }, args);
+    }
+    
+    Target target;
+    std::tuple<Args...> args;
+};
+
+template<typename T>
+struct CommandBuffer::RemoveComponentCommand : CommandBuffer::Command {
+    explicit RemoveComponentCommand(Target target) : target(target) {}
+    
+    void apply(World& world, CommandBuffer& buffer) override {
+        if(GameObject* obj = buffer.resolve(world, target)) {
+            world.removeComponent<T>(*obj);
+        }
+    }
+    
+    Target target;
+};
+
+inline CommandBuffer::PendingEntity CommandBuffer::spawn() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::uint32_t index = m_pendingCount++;
+    void* memory = allocate(sizeof(SpawnCommand), alignof(SpawnCommand));
+    m_commands.push_back(new (memory) SpawnCommand(index));
+    return PendingEntity{index};
+}
+
+inline void CommandBuffer::destroy(EntityHandle handle) {
+    // Destruction is collected and applied after every other command
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_destroyed.push_back(handle);
+}
+
+template<typename T, typename... Args>
+void CommandBuffer::addComponent(EntityHandle target, Args&&... args) {
+    record<AddComponentCommand<T, std::decay_t<Args>...>>(Target{target}, std::forward<Args>(args)...);
+}
+
+template<typename T, typename... Args>
+void CommandBuffer::addComponent(PendingEntity target, Args&&... args) {
+    record<AddComponentCommand<T, std::decay_t<Args>...>>(Target{EntityHandle(), target.index}, std::forward<Args>(args)...);
+}
+
+template<typename T>
+void CommandBuffer::removeComponent(EntityHandle target) {
+    record<RemoveComponentCommand<T>>(Target{target});
+}
+
+inline GameObject* CommandBuffer::resolve(World& world, const Target& target) const {
+    if(target.pending != UINT32_MAX) {
+        return world.resolve(m_spawned[target.pending]);
+    }
+    return world.resolve(target.handle);
+}
+
+inline void CommandBuffer::apply(World& world) {
+    m_spawned.assign(m_pendingCount, EntityHandle());
+    for(Command* command : m_commands) {
+        command->apply(world, *this);
+    }
+    world.destroyEntities(m_destroyed);
+    reset();
+}
+
+inline void World::flushCommands() {
+    m_commands.apply(*this);
+}
+
+// Iterating a view only visits the archetypes in its cache, so the cost is
+// proportional to the matching entities rather than the whole world.
+template<typename... Ts>
+class EntityView {
+public:
+    EntityView(World& world, QueryCache& cache) : m_world(&world), m_cache(&cache) {}
+    
+    // Same view, minus entities that have any of Us
+    template<typename... Us>
+    EntityView without() const {
+        const ComponentMask exclude = m_cache->exclude | (ComponentMask(0) | ... | componentBit<Us>());
+        return EntityView(*m_world, m_world->query(m_cache->include, exclude));
+    }
+    
+    // Calls fn(GameObject&, Ts&...) for each matching entity
+    template<typename Fn>
+    void each(Fn&& fn) const {
+        for(Archetype* arch : m_cache->archetypes) {
+            const auto& entities = arch->entities();
+            for(std::size_t row = 0; row < entities.size(); ++row) {
+                fn(*entities[row], arch->template component<Ts>(row)...);
+            }
+        }
+    }
+    
+    std::size_t size() const {
+        std::size_t count = 0;
+        for(Archetype* arch : m_cache->archetypes) {
+            count += arch->size();
+        }
+        return count;
+    }
+    
+    GameObject* first() const {
+        for(Archetype* arch : m_cache->archetypes) {
+            if(arch->size() > 0) return arch->entities().front();
+        }
+        return nullptr;
+    }
+    
+private:
+    World* m_world;
+    QueryCache* m_cache;
+};
+
+template<typename... Ts>
+EntityView<Ts...> World::view() {
+    return EntityView<Ts...>(*this, query((ComponentMask(0) | ... | componentBit<Ts>()), 0));
+}
+
+template<typename... Ts, typename Fn>
+void World::each(Fn&& fn) {
+    view<Ts...>().each(std::forward<Fn>(fn));
+}
+
+template<typename T, typename... Args>
+T* GameObject::add(Args&&... args) {
+    return World::getInstance().addComponent<T>(*this, std::forward<Args>(args)...);
+}
+
+inline GameObject& Component::parent() {
+    return *World::getInstance().resolve(m_parent);
+}
+
+// ========================
+// Required Components
+// ========================
+// ========================
+// Tiling Background Component
+// ========================
+class TilingBackgroundComponent final : public Component {
+    public:
+        static constexpr ComponentCaps kCaps = kCapsUpdate | kCapsDraw;
+        
+        TilingBackgroundComponent(const std::string& textureKey, float scrollSpeedX = 0.0f, float scrollSpeedY = 0.0f) 
+            : m_textureKey(textureKey), m_scrollSpeedX(scrollSpeedX), m_scrollSpeedY(scrollSpeedY), m_texture(nullptr) {}
+        
+        void update(float dt) override {
+            // Update scroll offsets for animated backgrounds
+            m_scrollOffsetX += m_scrollSpeedX * dt;
+            m_scrollOffsetY += m_scrollSpeedY * dt;
+            
+            // Wrap offsets to prevent overflow
+            if (m_scrollOffsetX >= m_textureWidth) m_scrollOffsetX -= m_textureWidth;
+            if (m_scrollOffsetX <= -m_textureWidth) m_scrollOffsetX += m_textureWidth;
+            if (m_scrollOffsetY >= m_textureHeight) m_scrollOffsetY -= m_textureHeight;
+            if (m_scrollOffsetY <= -m_textureHeight) m_scrollOffsetY += m_textureHeight;
+        }
+        
+        void draw(SDL_Renderer* renderer, const View& view) override {  // ADD 'override' here
+            if (!m_texture) {
+                m_texture = TextureManager::getInstance().getTexture(m_textureKey);
+                if (!m_texture) {
+                    SDL_SetRenderDrawColor(renderer, 135, 206, 235, 255);
+                    SDL_RenderClear(renderer);
+                    return;
+                }
+                
+                // Automatically get the actual texture dimensions
+                SDL_QueryTexture(m_texture, NULL, NULL, &m_textureWidth, &m_textureHeight);
+                
+                std::cout << "Tiling background loaded: " << m_textureKey 
+                          << " (" << m_textureWidth << "x" << m_textureHeight << ")" << std::endl;
+            }
+            
+            // Get screen dimensions
+            int screenWidth, screenHeight;
+            SDL_GetRendererOutputSize(renderer, &screenWidth, &screenHeight);
+            
+            // Calculate starting positions for tiling
+            int startX = static_cast<int>(-m_scrollOffsetX);
+            int startY = static_cast<int>(-m_scrollOffsetY);
+            
+            // Ensure we cover the entire screen with some margin
+            int tilesX = (screenWidth / m_textureWidth) + 2;
+            int tilesY = (screenHeight / m_textureHeight) + 2;
+            
+            // Draw tiled background
+            for (int y = 0; y < tilesY; y++) {
+                for (int x = 0; x < tilesX; x++) {
+                    SDL_Rect destRect = {
+                        startX + (x * m_textureWidth),
+                        startY + (y * m_textureHeight),
+                        m_textureWidth,
+                        m_textureHeight
+                    };
+                    SDL_RenderCopy(renderer, m_texture, NULL, &destRect);
+                }
+            }
+            
+            // Debug info (optional)
+            static int debugCounter = 0;
+            if (debugCounter++ % 300 == 0) {
+                std::cout << "Drawing tiling background: " << tilesX << "x" << tilesY << " tiles" 
+                          << " at offset (" << m_scrollOffsetX << "," << m_scrollOffsetY << ")" << std::endl;
+            }
+        }
+        
+        // Method to change scroll speed dynamically
+        void setScrollSpeed(float speedX, float speedY) {
+            m_scrollSpeedX = speedX;
+            m_scrollSpeedY = speedY;
+        }
+        
+    private:
+        std::string m_textureKey;
+        SDL_Texture* m_texture;
+        float m_scrollSpeedX;
+        float m_scrollSpeedY;
+        float m_scrollOffsetX = 0.0f;
+        float m_scrollOffsetY = 0.0f;
+        int m_textureWidth = 0;
+        int m_textureHeight = 0;
+    };
+// BodyComponent
+class BodyComponent final : public Component {
+public:
+    static constexpr ComponentCaps kCaps = kCapsUpdate;
+    
+    float x, y, width, height;
+    float velocityX = 0, velocityY = 0;
+    float angle = 0;
+    float prevX = 0, prevY = 0;
+    CollisionLayer layer = CollisionLayer::None;
+    LayerMask collidesWith = 0;
+    
+    BodyComponent(float x, float y, float w, float h) : x(x), y(y), width(w), height(h), prevX(x), prevY(y) {}
+    
+    void update(float dt) override {
+        prevX = x;
+        prevY = y;
+        
+        x += velocityX * dt;
+        y += velocityY * dt;
+    }
+    
+    // Moves without implying a velocity, e.g. when placing a new instance
+    void setPosition(float nx, float ny) {
+        x = prevX = nx;
+        y = prevY = ny;
+    }
+    
+    float getVelocityX() const { return x - prevX; }
+    float getVelocityY() const { return y - prevY; }
+};
+
+// PhysicsComponent - Handles gravity and ground collision for any object
+class PhysicsComponent final : public Component {
+public:
+    static constexpr ComponentCaps kCaps = kCapsUpdate;
+    
+    void update(float dt) override {
+        auto body = parent().get<BodyComponent>();
+        if(!body) return;
+        
+        // Apply gravity
+        body->velocityY += gravity * dt;
+        body->y += body->velocityY * dt;
+    }
+    
+    // Consecutive frames the body has been still with unchanged contacts
+    int restingFrames = 0;
+    
+private:
+    float gravity = 800.0f;
+};
+
+// SolidComponent - Marks an object as solid for collision (tag, no data)
+class SolidComponent {
+public:
+    static constexpr ComponentCaps kCaps = kCapsNone;
+};
+
+// EnemyComponent - Marks an object as an enemy that can kill the player (tag, no data)
+class EnemyComponent {
+public:
+    static constexpr ComponentCaps kCaps = kCapsNone;
+};
+
+// SpriteComponent with texture and sprite sheet support
+// SpriteComponent with texture and sprite sheet support
+class SpriteComponent final : public Component {
+    public:
+        static constexpr ComponentCaps kCaps = kCapsUpdate | kCapsDraw;
+        
+        SpriteComponent(const std::string& textureKey = "", SDL_Color color = {255, 255, 255, 255}) 
+            : m_textureKey(textureKey), m_color(color), m_texture(nullptr) {}
+        
+        void update(float dt) override {
+            // Update animation frame if needed
+            if(m_animated) {
+                m_animationTimer += dt;
+                if(m_animationTimer >= m_frameDuration) {
+                    m_animationTimer = 0;
+                    m_currentFrame = (m_currentFrame + 1) % m_totalFrames;
+                }
+            }
+        }
+        
+        void draw(SDL_Renderer* renderer, const View& view) override {
+            auto body = parent().get<BodyComponent>();
+            if(!body) return;
+            
+            SDL_Rect destRect = view.getTransformedRect(body->x, body->y, body->width, body->height);
+            
+            // If we have a texture, use it
+            if(m_texture) {
+                // For custom source rectangle (specific tile coordinates)
+                if(m_usingCustomSource) {
+                    SDL_RenderCopy(renderer, m_texture, &m_customSrcRect, &destRect);
+                }
+                // For sprite sheets with static frames (platforms)
+                else if(m_usingSpriteSheet && !m_animated) {
+                    // Calculate row and column for the static frame
+                    int row = m_currentFrame / m_framesPerRow;
+                    int col = m_currentFrame % m_framesPerRow;
+                    
+                    SDL_Rect srcRect = {
+                        m_spriteWidth * col,
+                        m_spriteHeight * row,
+                        m_spriteWidth,
+                        m_spriteHeight
+                    };
+                    SDL_RenderCopy(renderer, m_texture, &srcRect, &destRect);
+                }
+                // For animated sprite sheets (characters, enemies)
+                else if(m_usingSpriteSheet && m_animated) {
+                    int row = m_currentFrame / m_framesPerRow;
+                    int col = m_currentFrame % m_framesPerRow;
+                    
+                    SDL_Rect srcRect = {
+                        m_spriteWidth * col,
+                        m_spriteHeight * row,
+                        m_spriteWidth,
+                        m_spriteHeight
+                    };
+                    SDL_RenderCopy(renderer, m_texture, &srcRect, &destRect);
+                }
+                // For static textures (stretched to fit)
+                else {
+                    SDL_RenderCopy(renderer, m_texture, NULL, &destRect);
+                }
+            } 
+            // Otherwise fall back to colored rectangles
+            else {
+                SDL_SetRenderDrawColor(renderer, m_color.r, m_color.g, m_color.b, 255);
+                SDL_RenderFillRect(renderer, &destRect);
+                
+                SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+                SDL_RenderDrawRect(renderer, &destRect);
+            }
+        }
+        
+        // Texture management methods
+        void setTexture(SDL_Texture* texture) { 
+            m_texture = texture; 
+        }
+        
+        // For multi-row sprite sheets
+        void setSpriteSheet(int frameWidth, int frameHeight, int totalFrames, int framesPerRow, float frameRate = 10.0f) {
+            m_usingSpriteSheet = true;
+            m_spriteWidth = frameWidth;
+            m_spriteHeight = frameHeight;
+            m_totalFrames = totalFrames;
+            m_framesPerRow = framesPerRow;
+            m_frameDuration = 1.0f / frameRate;
+            m_animated = true;
+            
+            std::cout << "Sprite sheet configured: " << frameWidth << "x" << frameHeight 
+                      << ", " << totalFrames << " frames, " << framesPerRow << " per row" << std::endl;
+        }
+        
+        // For single-row sprite sheets (backward compatibility)
+        void setSpriteSheet(int frameWidth, int frameHeight, int totalFrames, float frameRate = 10.0f) {
+            setSpriteSheet(frameWidth, frameHeight, totalFrames, totalFrames, frameRate);
+        }
+        
+        void setStaticFrame(int frame) {
+            m_currentFrame = frame;
+            m_animated = false; // Don't animate platforms
+        }
+    
+        // Set specific tile from the sprite sheet
+        void setTile(int tileX, int tileY, int tileWidth, int tileHeight) {
+            m_usingSpriteSheet = true;
+            m_spriteWidth = tileWidth;
+            m_spriteHeight = tileHeight;
+            
+            // For platforms, we don't use frame calculation - we use direct source rectangle
+            m_usingCustomSource = true;
+            m_customSrcRect = {
+                tileX * tileWidth,
+                tileY * tileHeight,
+                tileWidth,
+                tileHeight
+            };
+            
+            m_animated = false; // Static for platforms
+            m_totalFrames = 1; // Only using one frame
+            
+            std::cout << "Tile set to: (" << tileX << "," << tileY << ") at position (" 
+                      << m_customSrcRect.x << "," << m_customSrcRect.y << ")" << std::endl;
+        }
+    
+        // Set specific source rectangle directly
+        void setSourceRect(int x, int y, int width, int height) {
+            m_usingCustomSource = true;
+            m_customSrcRect = {x, y, width, height};
+            m_animated = false;
+        }
+        
+    private:
+        std::string m_textureKey;
+        SDL_Color m_color;
+        SDL_Texture* m_texture;
+        SDL_Rect m_customSrcRect = {0, 0, 0, 0};
+    
+        // Sprite sheet animation properties
+        bool m_usingSpriteSheet = false;
+        bool m_animated = false;
+        int m_spriteWidth = 0;
+        int m_spriteHeight = 0;
+        int m_totalFrames = 1;
+        int m_framesPerRow = 1;  // frames per row for multi-row sheets
+        int m_currentFrame = 0;
+        float m_animationTimer = 0.0f;
+        float m_frameDuration = 0.1f;
+        bool m_usingCustomSource = false;
+    };
+
+// ========================
+// Collision System
+// ========================
+// Face of the other body a contact pushes out through
+enum class ContactNormal : std::uint8_t { None, Left, Right, Top, Bottom };
+
+class CollisionSystem {
+public:
+    static bool checkCollision(BodyComponent* a, BodyComponent* b) {
+        return (a->x < b->x + b->width &&
+                a->x + a->width > b->x &&
+                a->y < b->y + b->height &&
+                a->y + a->height > b->y);
+    }
+
+    static bool resolvePlatformCollision(BodyComponent* player, BodyComponent* platform, float platformVelocityX) {
+        return applyPlatformContact(player, platform, platformContactNormal(player, platform), platformVelocityX);
+    }
+    
+    // Face of 'platform' the player is pushed out through: the one of least overlap
+    static ContactNormal platformContactNormal(const BodyComponent* player, const BodyComponent* platform) {
+        // Calculate overlap in all directions
+        float overlapLeft = (player->x + player->width) - platform->x;
+        float overlapRight = (platform->x + platform->width) - player->x;
+        float overlapTop = (player->y + player->height) - platform->y;
+        float overlapBottom = (platform->y + platform->height) - player->y;
+
+        // Find the smallest overlap
+        bool fromLeft = std::abs(overlapLeft) < std::abs(overlapRight);
+        bool fromTop = std::abs(overlapTop) < std::abs(overlapBottom);
+
+        float minOverlapX = fromLeft ? overlapLeft : overlapRight;
+        float minOverlapY = fromTop ? overlapTop : overlapBottom;
+
+        // Resolve in the direction of least overlap
+        if(std::abs(minOverlapX) < std::abs(minOverlapY)) {
+            return fromLeft ? ContactNormal::Left : ContactNormal::Right;
+        }
+        return fromTop ? ContactNormal::Top : ContactNormal::Bottom;
+    }
+    
+    // Pushes the player out through 'normal'; returns true if it is now standing on the platform
+    static bool applyPlatformContact(BodyComponent* player, const BodyComponent* platform, ContactNormal normal, float platformVelocityX) {
+        switch(normal) {
+            case ContactNormal::Left:
+                player->x = platform->x - player->width;
+                player->velocityX = 0;
+                return false;
+            case ContactNormal::Right:
+                player->x = platform->x + platform->width;
+                player->velocityX = 0;
+                return false;
+            case ContactNormal::Top:
+                player->y = platform->y - player->height;
+                player->velocityY = 0;
+                
+                // NEW: Carry player with moving platform
+                if(std::abs(platformVelocityX) > 0.1f) {
+                    player->x += platformVelocityX;
+                }
+                
+                // Player is on top of platform
+                return true;
+            case ContactNormal::Bottom:
+                player->y = platform->y + platform->height;
+                player->velocityY = 0;
+                return false;
+            default:
+                return false;
+        }
+    }
+    
+    // How far 'a' is inside 'b' through the given face of b
+    static float penetration(const BodyComponent& a, const BodyComponent& b, ContactNormal normal) {
+        switch(normal) {
+            case ContactNormal::Left: return (a.x + a.width) - b.x;
+            case ContactNormal::Right: return (b.x + b.width) - a.x;
+            case ContactNormal::Top: return (a.y + a.height) - b.y;
+            case ContactNormal::Bottom: return (b.y + b.height) - a.y;
+            default: return 0;
+        }
+    }
+};
+
+// Contacts that lasted from one frame to the next, keyed by the two bodies'
+// handles. A body resting on another (shallow penetration, hardly any motion
+// relative to it since last frame) keeps last frame's normal, so the least-
+// penetration test is skipped and the normal does not flip with the small
+// per-frame sag from gravity. Only that classification is skipped: gravity
+// is integrated every tick, so the overlap test and the push-out still run
+// for resting pairs, and grounded state is still re-derived from each
+// frame's contacts. Pairs not touched in a frame are dropped, unless the
+// caller keeps them (e.g. those of a sleeping body).
+class ContactCache {
+public:
+    // Relative motion and penetration below this count as resting
+    static constexpr float kRestingSlop = 1.0f;
+    
+    struct Contact {
+        ContactNormal normal = ContactNormal::None;
+        CollisionLayer selfLayer = CollisionLayer::None;
+        CollisionLayer otherLayer = CollisionLayer::None;
+        float separation = 0;      // penetration along the normal when it was worked out
+        float relX = 0, relY = 0;  // self minus other position after resolving
+        std::uint32_t frame = 0;   // last frame the pair touched
+    };
+    
+    void beginFrame() {
+        ++m_frame;
+        m_reused.store(0, std::memory_order_relaxed);
+    }
+    
+    // Entry for the pair, created empty on first contact
+    Contact& touch(EntityHandle self, EntityHandle other) {
+        return m_contacts[key(self, other)];
+    }
+    
+    // Last stored state of the pair, or an empty contact; safe to call from
+    // several threads while nothing is touched
+    Contact find(EntityHandle self, EntityHandle other) const {
+        auto it = m_contacts.find(key(self, other));
+        return it != m_contacts.end() ? it->second : Contact();
+    }
+    
+    bool touchedLastFrame(const Contact& contact) const { return contact.frame + 1 == m_frame; }
+    
+    // Last frame's normal, if the pair was resting then and has barely moved
+    // relative to each other since; ContactNormal::None means work it out again.
+    // Thread safe.
+    ContactNormal restingNormal(const Contact& contact, const BodyComponent& self, const BodyComponent& other) {
+        if(!touchedLastFrame(contact) || contact.normal == ContactNormal::None) return ContactNormal::None;
+        if(contact.separation > kRestingSlop) return ContactNormal::None;
+        
+        const float moved = std::abs((self.x - other.x) - contact.relX) + std::abs((self.y - other.y) - contact.relY);
+        if(moved > kRestingSlop) return ContactNormal::None;
+        
+        m_reused.fetch_add(1, std::memory_order_relaxed);
+        return contact.normal;
+    }
+    
+    void store(Contact& contact, ContactNormal normal, float separation, const BodyComponent& self, const BodyComponent& other) {
+        contact.normal = normal;
+        contact.selfLayer = self.layer;
+        contact.otherLayer = other.layer;
+        contact.separation = separation;
+        contact.relX = self.x - other.x;
+        contact.relY = self.y - other.y;
+        contact.frame = m_frame;
+    }
+    
+    // Forgets pairs that were not in contact this frame, passing each to
+    // onExit(self, other, contact) first, ordered by their handles. Pairs
+    // for which keep(self, other) is true count as touched this frame instead.
+    template<typename KeepFn, typename ExitFn>
+    void endFrame(KeepFn&& keep, ExitFn&& onExit) {
+        m_exited.clear();
+        for(auto it = m_contacts.begin(); it != m_contacts.end();) {
+            if(it->second.frame == m_frame) {
+                ++it;
+                continue;
+            }
+            if(keep(selfOf(it->first), otherOf(it->first))) {
+                it->second.frame = m_frame;
+                ++it;
+                continue;
+            }
+            m_exited.emplace_back(it->first, it->second);
+            it = m_contacts.erase(it);
+        }
+        
+        std::sort(m_exited.begin(), m_exited.end(),
+                  [](const auto& a, const auto& b) { return a.first < b.first; });
+        for(const auto& [pairKey, contact] : m_exited) {
+            onExit(selfOf(pairKey), otherOf(pairKey), contact);
+        }
+    }
+    
+    std::size_t size() const { return m_contacts.size(); }
+    std::size_t reusedThisFrame() const { return m_reused.load(std::memory_order_relaxed); }
+    
+private:
+    static std::uint64_t key(EntityHandle self, EntityHandle other) {
+        return (std::uint64_t(self.value) << 32) | other.value;
+    }
+    
+    static EntityHandle selfOf(std::uint64_t pairKey) {
+        EntityHandle handle;
+        handle.value = static_cast<std::uint32_t>(pairKey >> 32);
+        return handle;
+    }
+    
+    static EntityHandle otherOf(std::uint64_t pairKey) {
+        EntityHandle handle;
+        handle.value = static_cast<std::uint32_t>(pairKey);
+        return handle;
+    }
+    
+    std::unordered_map<std::uint64_t, Contact> m_contacts;
+    std::vector<std::pair<std::uint64_t, Contact>> m_exited;
+    std::uint32_t m_frame = 1;  // new entries have frame 0, which is never last frame
+    std::atomic<std::size_t> m_reused{0};
+};
+
+enum class ContactPhase : std::uint8_t { Enter, Stay, Exit };
+
+// One contact as gameplay sees it, after positions have been resolved
+struct ContactEvent {
+    EntityHandle self;   // the body that resolved the contact
+    EntityHandle other;
+    CollisionLayer selfLayer;
+    CollisionLayer otherLayer;
+    ContactPhase phase;
+    ContactNormal normal;  // face of 'other' that self was pushed out through
+};
+
+// The contact events of one collision pass, bucketed by (self layer, other
+// layer), so each gameplay handler walks one contiguous batch of its pair.
+class ContactEventBuffer {
+public:
+    void clear() {
+        for(auto& bucket : m_buckets) bucket.clear();
+    }
+    
+    void push(const ContactEvent& event) {
+        m_buckets[bucketIndex(event.selfLayer, event.otherLayer)].push_back(event);
+    }
+    
+    const std::vector<ContactEvent>& batch(CollisionLayer self, CollisionLayer other) const {
+        return m_buckets[bucketIndex(self, other)];
+    }
+    
+    // Calls fn(event) for every event, one bucket after another
+    template<typename Fn>
+    void forEach(Fn&& fn) const {
+        for(const auto& bucket : m_buckets) {
+            for(const ContactEvent& event : bucket) fn(event);
+        }
+    }
+    
+    std::size_t size() const {
+        std::size_t total = 0;
+        for(const auto& bucket : m_buckets) total += bucket.size();
+        return total;
+    }
+    
+private:
+    static std::size_t bucketIndex(CollisionLayer self, CollisionLayer other) {
+        return static_cast<std::size_t>(self) * kCollisionLayerCount + static_cast<std::size_t>(other);
+    }
+    
+    std::array<std::vector<ContactEvent>, kCollisionLayerCount * kCollisionLayerCount> m_buckets;
+};
+
+// ========================
+// Broadphase
+// ========================
+// Axis-aligned box; overlap uses the same strict test as checkCollision
+struct Aabb {
+    float minX, minY, maxX, maxY;
+    
+    static Aabb of(const BodyComponent& body) {
+        return { body.x, body.y, body.x + body.width, body.y + body.height };
+    }
+    
+    // Everything the body covered moving from (prevX, prevY) to (x, y) this frame
+    static Aabb swept(const BodyComponent& body) {
+        return { std::min(body.x, body.prevX), std::min(body.y, body.prevY),
+                 std::max(body.x, body.prevX) + body.width, std::max(body.y, body.prevY) + body.height };
+    }
+    
+    Aabb expanded(float margin) const {
+        return { minX - margin, minY - margin, maxX + margin, maxY + margin };
+    }
+    
+    bool overlaps(const Aabb& other) const {
+        return minX < other.maxX && maxX > other.minX && minY < other.maxY && maxY > other.minY;
+    }
+    
+    bool contains(const Aabb& other) const {
+        return minX <= other.minX && minY <= other.minY && maxX >= other.maxX && maxY >= other.maxY;
+    }
+};
+
+// Where a box moving by (dx, dy) first touches a stationary target
+struct SweepHit {
+    float time;      // fraction of the move, in [0, 1)
+    bool alongX;     // the axis whose faces met last, i.e. the contact normal
+    float exitTime;  // when the box clears the target's far face on that axis
+};
+
+// Times at which an extent moving by d overlaps a stationary one on one
+// axis; false if it never does
+inline bool sweepSlab(float boxMin, float boxMax, float targetMin, float targetMax, float d, float& entry, float& exit) {
+    constexpr float kInf = std::numeric_limits<float>::infinity();
+    if(d == 0) {
+        entry = -kInf;
+        exit = kInf;
+        return boxMin < targetMax && boxMax > targetMin;
+    }
+    const float toNear = d > 0 ? targetMin - boxMax : targetMax - boxMin;
+    const float toFar = d > 0 ? targetMax - boxMin : targetMin - boxMax;
+    entry = toNear / d;
+    exit = toFar / d;
+    return true;
+}
+
+// Slab test on both axes: the box overlaps the target on an axis between
+// that axis' entry and exit times, and overall once both have entered.
+// Boxes already overlapping at the start are not hits.
+inline bool sweepAabb(const Aabb& box, float dx, float dy, const Aabb& target, SweepHit& hit) {
+    float entryX, exitX, entryY, exitY;
+    if(!sweepSlab(box.minX, box.maxX, target.minX, target.maxX, dx, entryX, exitX)) return false;
+    if(!sweepSlab(box.minY, box.maxY, target.minY, target.maxY, dy, entryY, exitY)) return false;
+    
+    const float entry = std::max(entryX, entryY);
+    const float exit = std::min(exitX, exitY);
+    if(entry >= exit || entry < 0 || entry >= 1) return false;
+    
+    hit.time = entry;
+    hit.alongX = entryX > entryY;
+    hit.exitTime = hit.alongX ? exitX : exitY;
+    return true;
+}
+
+// Whether the moving box overlaps the target at any time before maxTime,
+// including at the start. Never false where sweepAabb finds an earlier hit,
+// so it can cull whole groups of targets by their bounds.
+inline bool sweepReaches(const Aabb& box, float dx, float dy, const Aabb& target, float maxTime) {
+    float entryX, exitX, entryY, exitY;
+    if(!sweepSlab(box.minX, box.maxX, target.minX, target.maxX, dx, entryX, exitX)) return false;
+    if(!sweepSlab(box.minY, box.maxY, target.minY, target.maxY, dy, entryY, exitY)) return false;
+    
+    const float entry = std::max(entryX, entryY);
+    const float exit = std::min(exitX, exitY);
+    return entry < exit && exit > 0 && entry < maxTime;
+}
+
+// ========================
+// Batch Overlap Kernels
+// ========================
+// Tests one box against many, stored as separate arrays of min/max
+// coordinates so a vector register holds the same field of 4 or 8 boxes.
+// Bit i of the output is set when box i overlaps, using the same strict
+// comparisons as CollisionSystem::checkCollision. The widest kernel the CPU
+// supports is picked once at startup, since the binary runs on mixed
+// hardware: AVX2 (16 boxes per step), SSE2 (8 per step) or plain scalar.
+struct AabbBatch {
+    std::vector<float> minX, minY, maxX, maxY;
+    
+    void clear() {
+        minX.clear();
+        minY.clear();
+        maxX.clear();
+        maxY.clear();
+    }
+    
+    void push(const Aabb& box) {
+        minX.push_back(box.minX);
+        minY.push_back(box.minY);
+        maxX.push_back(box.maxX);
+        maxY.push_back(box.maxY);
+    }
+    
+    std::size_t size() const { return minX.size(); }
+};
+
+// Writes (count + 63) / 64 words of hits for boxes [first, first + count) of the batch arrays
+using OverlapKernel = void (*)(const Aabb& box, const float* minX, const float* minY,
+                               const float* maxX, const float* maxY, std::size_t count, std::uint64_t* hits);
+
+inline void overlapTail(const Aabb& box, const float* minX, const float* minY, const float* maxX, const float* maxY,
+                        std::size_t begin, std::size_t count, std::uint64_t* hits) {
+    for(std::size_t i = begin; i < count; ++i) {
+        const bool hit = box.minX < maxX[i] && box.maxX > minX[i] && box.minY < maxY[i] && box.maxY > minY[i];
+        hits[i >> 6] |= std::uint64_t(hit) << (i & 63);
+    }
+}
+
+inline void overlapScalar(const Aabb& box, const float* minX, const float* minY,
+                          const float* maxX, const float* maxY, std::size_t count, std::uint64_t* hits) {
+    std::fill(hits, hits + (count + 63) / 64, 0);
+    overlapTail(box, minX, minY, maxX, maxY, 0, count, hits);
+}
+
+#if defined(OVERLAP_SIMD_X86)
+// GCC and Clang only emit wider instructions inside functions marked for them;
+// MSVC allows the intrinsics anywhere.
+#if defined(__GNUC__)
+#define OVERLAP_TARGET_SSE2 __attribute__((target("sse2")))
+#define OVERLAP_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define OVERLAP_TARGET_SSE2
+#define OVERLAP_TARGET_AVX2
+#endif
+
+OVERLAP_TARGET_SSE2
+inline std::uint64_t overlapLanesSse2(const Aabb& box, const float* minX, const float* minY,
+                                      const float* maxX, const float* maxY) {
+    __m128 hit = _mm_cmplt_ps(_mm_set1_ps(box.minX), _mm_loadu_ps(maxX));
+    hit = _mm_and_ps(hit, _mm_cmpgt_ps(_mm_set1_ps(box.maxX), _mm_loadu_ps(minX)));
+    hit = _mm_and_ps(hit, _mm_cmplt_ps(_mm_set1_ps(box.minY), _mm_loadu_ps(maxY)));
+    hit = _mm_and_ps(hit, _mm_cmpgt_ps(_mm_set1_ps(box.maxY), _mm_loadu_ps(minY)));
+    return static_cast<std::uint64_t>(_mm_movemask_ps(hit));
+}
+
+OVERLAP_TARGET_SSE2
+inline void overlapSse2(const Aabb& box, const float* minX, const float* minY,
+                        const float* maxX, const float* maxY, std::size_t count, std::uint64_t* hits) {
+    std::fill(hits, hits + (count + 63) / 64, 0);
+    std::size_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        const std::uint64_t low = overlapLanesSse2(box, minX + i, minY + i, maxX + i, maxY + i);
+        const std::uint64_t high = overlapLanesSse2(box, minX + i + 4, minY + i + 4, maxX + i + 4, maxY + i + 4);
+        hits[i >> 6] |= (low | (high << 4)) << (i & 63);
+    }
+    overlapTail(box, minX, minY, maxX, maxY, i, count, hits);
+}
+
+OVERLAP_TARGET_AVX2
+inline std::uint64_t overlapLanesAvx2(const Aabb& box, const float* minX, const float* minY,
+                                      const float* maxX, const float* maxY) {
+    __m256 hit = _mm256_cmp_ps(_mm256_set1_ps(box.minX), _mm256_loadu_ps(maxX), _CMP_LT_OQ);
+    hit = _mm256_and_ps(hit, _mm256_cmp_ps(_mm256_set1_ps(box.maxX), _mm256_loadu_ps(minX), _CMP_GT_OQ));
+    hit = _mm256_and_ps(hit, _mm256_cmp_ps(_mm256_set1_ps(box.minY), _mm256_loadu_ps(maxY), _CMP_LT_OQ));
+    hit = _mm256_and_ps(hit, _mm256_cmp_ps(_mm256_set1_ps(box.maxY), _mm256_loadu_ps(minY), _CMP_GT_OQ));
+    return static_cast<std::uint64_t>(_mm256_movemask_ps(hit));
+}
+
+OVERLAP_TARGET_AVX2
+inline void overlapAvx2(const Aabb& box, const float* minX, const float* minY,
+                        const float* maxX, const float* maxY, std::size_t count, std::uint64_t* hits) {
+    std::fill(hits, hits + (count + 63) / 64, 0);
+    std::size_t i = 0;
+    for(; i + 16 <= count; i += 16) {
+        const std::uint64_t low = overlapLanesAvx2(box, minX + i, minY + i, maxX + i, maxY + i);
+        const std::uint64_t high = overlapLanesAvx2(box, minX + i + 8, minY + i + 8, maxX + i + 8, maxY + i + 8);
+        hits[i >> 6] |= (low | (high << 8)) << (i & 63);
+    }
+    overlapTail(box, minX, minY, maxX, maxY, i, count, hits);
+}
+#endif
+
+struct OverlapKernelChoice {
+    OverlapKernel kernel;
+    const char* name;
+};
+
+inline OverlapKernelChoice selectOverlapKernel() {
+#if defined(OVERLAP_SIMD_X86)
+    bool avx2 = false;
+    bool sse2 = false;
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+    __cpuid(info, 1);
+    sse2 = (info[3] & (1 << 26)) != 0;
+    const bool osUsesYmm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+    if(maxLeaf >= 7 && osUsesYmm) {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+    }
+#else
+    __builtin_cpu_init();
+    avx2 = __builtin_cpu_supports("avx2");
+    sse2 = __builtin_cpu_supports("sse2");
+#endif
+    if(avx2) return { &overlapAvx2, "avx2" };
+    if(sse2) return { &overlapSse2, "sse2" };
+#endif
+    return { &overlapScalar, "scalar" };
+}
+
+inline const OverlapKernelChoice& overlapKernel() {
+    static const OverlapKernelChoice choice = selectOverlapKernel();
+    return choice;
+}
+
+// Hits of 'box' against batch entries [first, batch.size()), bit 0 = entry 'first'
+inline void overlapBatch(const Aabb& box, const AabbBatch& batch, std::size_t first, std::vector<std::uint64_t>& hits) {
+    const std::size_t count = batch.size() - first;
+    hits.resize((count + 63) / 64);
+    overlapKernel().kernel(box, batch.minX.data() + first, batch.minY.data() + first,
+                           batch.maxX.data() + first, batch.maxY.data() + first, count, hits.data());
+}
+
+// One collidable body as the broadphase sees it. Pointers stay valid until
+// the next build(), as nothing structural happens during collision.
+struct BroadphaseProxy {
+    Aabb bounds;
+    GameObject* object;
+    BodyComponent* body;
+    EntityHandle handle;
+    LayerMask layer;         // layerBit of the body's layer
+    LayerMask collidesWith;
+};
+
+inline BroadphaseProxy makeProxy(const Aabb& bounds, GameObject& obj, BodyComponent& body) {
+    return { bounds, &obj, &body, obj.handle(), layerBit(body.layer), body.collidesWith };
+}
+
+inline bool canCollide(const BroadphaseProxy& a, const BroadphaseProxy& b) {
+    return (a.collidesWith & b.layer) && (b.collidesWith & a.layer);
+}
+
+// Gives a body still on CollisionLayer::None the defaults for what it is:
+// players hit enemies and solids, enemies hit players (and solids if they
+// fall), solids hit both. Run when a body's proxy is built, so bodies made
+// in code collide without being assigned a layer; anything else stays on None.
+inline void applyDefaultCollisionLayer(ComponentMask mask, BodyComponent& body) {
+    if(body.layer != CollisionLayer::None) return;
+    
+    if(mask & componentBit<ControllerComponent>()) {
+        body.layer = CollisionLayer::Player;
+        body.collidesWith = layerBit(CollisionLayer::Enemy) | layerBit(CollisionLayer::Solid);
+    } else if(mask & componentBit<EnemyComponent>()) {
+        body.layer = CollisionLayer::Enemy;
+        body.collidesWith = layerBit(CollisionLayer::Player);
+        if(mask & componentBit<PhysicsComponent>()) body.collidesWith |= layerBit(CollisionLayer::Solid);
+    } else if(mask & componentBit<SolidComponent>()) {
+        body.layer = CollisionLayer::Solid;
+        body.collidesWith = layerBit(CollisionLayer::Player) | layerBit(CollisionLayer::Enemy);
+    }
+}
+
+// Two overlapping proxies, a < b
+struct BroadphasePair {
+    std::uint32_t a, b;
+    
+    bool operator<(const BroadphasePair& other) const {
+        return a != other.a ? a < other.a : b < other.b;
+    }
+};
+
+// Contiguous run of proxy indices
+struct IndexRange {
+    const std::uint32_t* first;
+    const std::uint32_t* last;
+    
+    const std::uint32_t* begin() const { return first; }
+    const std::uint32_t* end() const { return last; }
+};
+
+// Finds the bodies whose bounds overlap, so collision only runs the exact
+// test on nearby pairs. build() snapshots every dynamic body once per frame
+// (static ones live in the StaticBvh, bodies on no layer are left out) and
+// collects the overlapping pairs whose layers can collide. Results are proxy indices in ascending order, which
+// is the World's iteration order, so resolution order does not depend on the
+// broadphase in use. query() is const and safe to call from several threads.
+class Broadphase {
+public:
+    // Players resolve their own contacts and get pushed while doing so, so
+    // their proxies are padded to still pair with bodies they are pushed into.
+    // Proxies cover the whole of this frame's motion for the swept tests.
+    static constexpr float kContactMargin = 32.0f;
+    // Sleeping bodies sit exactly against what holds them up, so their
+    // proxies are padded to still pair with a support that starts moving
+    static constexpr float kSleepMargin = 1.0f;
+    
+    virtual ~Broadphase() = default;
+    virtual const char* name() const = 0;
+    
+    void build(World& world) {
+        m_proxies.clear();
+        world.view<BodyComponent>().without<TilingBackgroundComponent>().each([this](GameObject& obj, BodyComponent& body) {
+            applyDefaultCollisionLayer(obj.mask(), body);
+            if(!isStaticBody(obj.mask()) && body.layer != CollisionLayer::None && body.collidesWith) {
+                Aabb bounds = Aabb::swept(body);
+                if(obj.has<ControllerComponent>()) {
+                    bounds = bounds.expanded(kContactMargin);
+                } else if(obj.has<SleepingComponent>()) {
+                    bounds = bounds.expanded(kSleepMargin);
+                }
+                m_proxies.push_back(makeProxy(bounds, obj, body));
+            }
+        });
+        rebuild();
+        
+        m_pairs.clear();
+        findPairs(m_pairs);
+        indexPartners();
+    }
+    
+    // Appends the indices of proxies overlapping 'box' to 'out'
+    virtual void query(const Aabb& box, std::vector<std::uint32_t>& out) const = 0;
+    
+    const BroadphaseProxy& proxy(std::uint32_t index) const { return m_proxies[index]; }
+    std::size_t proxyCount() const { return m_proxies.size(); }
+    
+    // Every overlapping pair that can collide from the last build(), sorted
+    const std::vector<BroadphasePair>& pairs() const { return m_pairs; }
+    
+    // Proxies paired with 'index' in the last build(), ascending
+    IndexRange partners(std::uint32_t index) const {
+        const std::uint32_t* data = m_partners.data();
+        return { data + m_partnerStart[index], data + m_partnerStart[index + 1] };
+    }
+    
+protected:
+    // Called after m_proxies has been refilled
+    virtual void rebuild() = 0;
+    
+    // Appends every overlapping pair that passes canCollide; the default
+    // queries each proxy's bounds
+    virtual void findPairs(std::vector<BroadphasePair>& out) const {
+        std::vector<std::uint32_t> hits;
+        for(std::uint32_t i = 0; i < m_proxies.size(); ++i) {
+            hits.clear();
+            query(m_proxies[i].bounds, hits);
+            for(std::uint32_t j : hits) {
+                if(j > i && canCollide(m_proxies[i], m_proxies[j])) out.push_back({ i, j });
+            }
+        }
+    }
+    
+    std::vector<BroadphasePair> m_pairs;
+    std::vector<BroadphaseProxy> m_proxies;
+    
+private:
+    // Lays the pairs out per proxy (CSR), so partners() is a slice
+    void indexPartners() {
+        std::sort(m_pairs.begin(), m_pairs.end());
+        m_partnerStart.assign(m_proxies.size() + 1, 0);
+        for(const BroadphasePair& pair : m_pairs) {
+            m_partnerStart[pair.a + 1]++;
+            m_partnerStart[pair.b + 1]++;
+        }
+        for(std::size_t i = 1; i < m_partnerStart.size(); ++i) {
+            m_partnerStart[i] += m_partnerStart[i - 1];
+        }
+        
+        m_partners.resize(m_pairs.size() * 2);
+        m_partnerFill.assign(m_partnerStart.begin(), m_partnerStart.end() - 1);
+        for(const BroadphasePair& pair : m_pairs) {
+            m_partners[m_partnerFill[pair.a]++] = pair.b;
+            m_partners[m_partnerFill[pair.b]++] = pair.a;
+        }
+        for(std::size_t i = 0; i < m_proxies.size(); ++i) {
+            std::sort(m_partners.begin() + m_partnerStart[i], m_partners.begin() + m_partnerStart[i + 1]);
+        }
+    }
+    
+    std::vector<std::uint32_t> m_partners;
+    std::vector<std::uint32_t> m_partnerStart;
+    std::vector<std::uint32_t> m_partnerFill;
+};
+
+// Tests the box against every proxy. Reference behaviour and baseline for timing.
+class NaiveBroadphase : public Broadphase {
+public:
+    const char* name() const override { return "naive"; }
+    
+    void query(const Aabb& box, std::vector<std::uint32_t>& out) const override {
+        for(std::uint32_t i = 0; i < m_proxies.size(); ++i) {
+            if(m_proxies[i].bounds.overlaps(box)) out.push_back(i);
+        }
+    }
+    
+protected:
+    void rebuild() override {}
+};
+
+// Uniform grid hashed by cell coordinate. Each proxy is listed in every cell
+// its bounds touch, and a query only visits the cells under its box, so cost
+// follows local density instead of level size. Cell lists are cleared rather
+// than freed between frames, so steady-state rebuilds do not allocate; a cell
+// that stays empty for a whole build is evicted, so the table only holds the
+// cells bodies have touched recently rather than every cell they ever crossed.
+class SpatialHashGrid : public Broadphase {
+public:
+    explicit SpatialHashGrid(float cellSize = 128.0f) : m_cellSize(cellSize), m_invCellSize(1.0f / cellSize) {}
+    
+    const char* name() const override { return "grid"; }
+    float cellSize() const { return m_cellSize; }
+    
+    void query(const Aabb& box, std::vector<std::uint32_t>& out) const override {
+        const std::size_t first = out.size();
+        forEachCell(box, [&](std::uint64_t key) {
+            auto it = m_cells.find(key);
+            if(it == m_cells.end()) return;
+            for(std::uint32_t index : it->second) {
+                if(m_proxies[index].bounds.overlaps(box)) out.push_back(index);
+            }
+        });
+        
+        // A proxy spanning several cells is found once per cell
+        std::sort(out.begin() + first, out.end());
+        out.erase(std::unique(out.begin() + first, out.end()), out.end());
+    }
+    
+protected:
+    void rebuild() override {
+        for(auto it = m_cells.begin(); it != m_cells.end();) {
+            if(it->second.empty()) {
+                it = m_cells.erase(it);
+            } else {
+                it->second.clear();
+                ++it;
+            }
+        }
+        for(std::uint32_t i = 0; i < m_proxies.size(); ++i) {
+            forEachCell(m_proxies[i].bounds, [&](std::uint64_t key) { m_cells[key].push_back(i); });
+        }
+    }
+    
+private:
+    static std::uint64_t cellKey(int cx, int cy) {
+        return (std::uint64_t(std::uint32_t(cx)) << 32) | std::uint32_t(cy);
+    }
+    
+    template<typename Fn>
+    void forEachCell(const Aabb& box, Fn&& fn) const {
+        const int x0 = static_cast<int>(std::floor(box.minX * m_invCellSize));
+        const int y0 = static_cast<int>(std::floor(box.minY * m_invCellSize));
+        const int x1 = static_cast<int>(std::floor(box.maxX * m_invCellSize));
+        const int y1 = static_cast<int>(std::floor(box.maxY * m_invCellSize));
+        for(int cy = y0; cy <= y1; ++cy) {
+            for(int cx = x0; cx <= x1; ++cx) {
+                fn(cellKey(cx, cy));
+            }
+        }
+    }
+    
+    float m_cellSize;
+    float m_invCellSize;
+    std::unordered_map<std::uint64_t, std::vector<std::uint32_t>> m_cells;
+};
+
+// Spatial hash with several levels, each with cells twice the size of the
+// one below. A proxy is listed only at the finest level whose cells are at
+// least as big as its longer side, so it touches at most 2x2 cells there:
+// a 1000-unit platform and a 20-unit enemy each get a cell size that fits
+// them. Queries walk the occupied levels coarse to fine, and pairs are found
+// from the finer proxy of the two, so long bodies never scan the fine levels.
+// Each level hashes its cells into a table sized to what it holds, laid out
+// flat (CSR) and refilled every build, so lookups are an array read and
+// nothing is left behind by bodies that moved on.
+class HierarchicalGrid : public Broadphase {
+public:
+    static constexpr int kLevelCount = 10;
+    
+    explicit HierarchicalGrid(float baseCellSize = 32.0f) {
+        for(int level = 0; level < kLevelCount; ++level) {
+            m_levels[level].cellSize = baseCellSize * static_cast<float>(1 << level);
+            m_levels[level].invCellSize = 1.0f / m_levels[level].cellSize;
+        }
+    }
+    
+    const char* name() const override { return "hgrid"; }
+    
+    void query(const Aabb& box, std::vector<std::uint32_t>& out) const override {
+        const std::size_t first = out.size();
+        queryLevels(box, 0, out);
+        std::sort(out.begin() + first, out.end());
+    }
+    
+protected:
+    void rebuild() override {
+        for(Level& grid : m_levels) {
+            grid.proxies.clear();
+        }
+        m_levelOf.resize(m_proxies.size());
+        for(std::uint32_t i = 0; i < m_proxies.size(); ++i) {
+            m_levelOf[i] = levelFor(m_proxies[i].bounds);
+            m_levels[m_levelOf[i]].proxies.push_back(i);
+        }
+        for(Level& grid : m_levels) {
+            fillBuckets(grid);
+        }
+    }
+    
+    // Each proxy looks at its own level and the coarser ones; a pair on one
+    // level is kept from its lower index
+    void findPairs(std::vector<BroadphasePair>& out) const override {
+        std::vector<std::uint32_t> hits;
+        for(std::uint32_t i = 0; i < m_proxies.size(); ++i) {
+            hits.clear();
+            queryLevels(m_proxies[i].bounds, m_levelOf[i], hits);
+            for(std::uint32_t j : hits) {
+                if(j == i || (m_levelOf[j] == m_levelOf[i] && j < i)) continue;
+                if(canCollide(m_proxies[i], m_proxies[j])) out.push_back({ std::min(i, j), std::max(i, j) });
+            }
+        }
+    }
+    
+private:
+    // Inclusive cell coordinates covered by a box at one level
+    struct CellRange {
+        int x0, y0, x1, y1;
+        
+        std::uint64_t count() const {
+            return std::uint64_t(x1 - x0 + 1) * std::uint64_t(y1 - y0 + 1);
+        }
+    };
+    
+    // Bucket b lists the proxies with a cell hashing to b, in
+    // entries[bucketStart[b], bucketStart[b + 1]). Cells sharing a bucket
+    // just add candidates that fail the overlap test.
+    struct Level {
+        float cellSize = 0;
+        float invCellSize = 0;
+        std::vector<std::uint32_t> proxies;  // every proxy stored at this level
+        std::vector<std::uint32_t> bucketStart;
+        std::vector<std::uint32_t> entries;
+        std::uint32_t bucketMask = 0;
+        
+        CellRange cellsUnder(const Aabb& box) const {
+            return { static_cast<int>(std::floor(box.minX * invCellSize)), static_cast<int>(std::floor(box.minY * invCellSize)),
+                     static_cast<int>(std::floor(box.maxX * invCellSize)), static_cast<int>(std::floor(box.maxY * invCellSize)) };
+        }
+        
+        std::uint32_t bucket(int cx, int cy) const {
+            return ((std::uint32_t(cx) * 73856093u) ^ (std::uint32_t(cy) * 19349663u)) & bucketMask;
+        }
+    };
+    
+    // Lays out one level's buckets, with about two per cell entry. A proxy
+    // whose cells share a bucket is listed in it once.
+    void fillBuckets(Level& grid) {
+        std::size_t cellEntries = 0;
+        for(std::uint32_t index : grid.proxies) {
+            cellEntries += grid.cellsUnder(m_proxies[index].bounds).count();
+        }
+        std::uint32_t bucketCount = 16;
+        while(bucketCount < 2 * cellEntries) bucketCount *= 2;
+        grid.bucketMask = bucketCount - 1;
+        grid.bucketStart.assign(bucketCount + 1, 0);
+        
+        auto bucketsOf = [&](std::uint32_t index) {
+            m_scratch.clear();
+            const CellRange range = grid.cellsUnder(m_proxies[index].bounds);
+            for(int cy = range.y0; cy <= range.y1; ++cy) {
+                for(int cx = range.x0; cx <= range.x1; ++cx) {
+                    m_scratch.push_back(grid.bucket(cx, cy));
+                }
+            }
+            std::sort(m_scratch.begin(), m_scratch.end());
+            m_scratch.erase(std::unique(m_scratch.begin(), m_scratch.end()), m_scratch.end());
+            return IndexRange{ m_scratch.data(), m_scratch.data() + m_scratch.size() };
+        };
+        
+        for(std::uint32_t index : grid.proxies) {
+            for(std::uint32_t b : bucketsOf(index)) grid.bucketStart[b + 1]++;
+        }
+        for(std::size_t b = 1; b < grid.bucketStart.size(); ++b) {
+            grid.bucketStart[b] += grid.bucketStart[b - 1];
+        }
+        
+        grid.entries.resize(grid.bucketStart.back());
+        m_bucketFill.assign(grid.bucketStart.begin(), grid.bucketStart.end() - 1);
+        for(std::uint32_t index : grid.proxies) {
+            for(std::uint32_t b : bucketsOf(index)) grid.entries[m_bucketFill[b]++] = index;
+        }
+    }
+    
+    // Appends the proxies on levels 'lowest' and up that overlap 'box', each once
+    void queryLevels(const Aabb& box, int lowest, std::vector<std::uint32_t>& out) const {
+        for(int level = kLevelCount - 1; level >= lowest; --level) {
+            const Level& grid = m_levels[level];
+            if(grid.proxies.empty()) continue;
+            
+            // Testing a sparse level's proxies directly beats visiting many cells
+            const CellRange range = grid.cellsUnder(box);
+            if(range.count() > grid.proxies.size()) {
+                for(std::uint32_t index : grid.proxies) {
+                    if(m_proxies[index].bounds.overlaps(box)) out.push_back(index);
+                }
+                continue;
+            }
+            for(int cy = range.y0; cy <= range.y1; ++cy) {
+                for(int cx = range.x0; cx <= range.x1; ++cx) {
+                    const std::uint32_t b = grid.bucket(cx, cy);
+                    for(std::uint32_t e = grid.bucketStart[b]; e < grid.bucketStart[b + 1]; ++e) {
+                        const std::uint32_t index = grid.entries[e];
+                        const Aabb& bounds = m_proxies[index].bounds;
+                        if(!bounds.overlaps(box)) continue;
+                        
+                        // A proxy in several cells is reported from the first cell it shares with the box
+                        const CellRange cells = grid.cellsUnder(bounds);
+                        if(cx == std::max(range.x0, cells.x0) && cy == std::max(range.y0, cells.y0)) out.push_back(index);
+                    }
+                }
+            }
+        }
+    }
+    
+    // Finest level whose cells fit the box's longer side; bigger boxes go on the top level
+    int levelFor(const Aabb& box) const {
+        const float extent = std::max(box.maxX - box.minX, box.maxY - box.minY);
+        int level = 0;
+        while(level < kLevelCount - 1 && m_levels[level].cellSize < extent) ++level;
+        return level;
+    }
+    
+    std::array<Level, kLevelCount> m_levels;
+    std::vector<int> m_levelOf;  // by proxy index
+    std::vector<std::uint32_t> m_scratch;
+    std::vector<std::uint32_t> m_bucketFill;
+};
+
+// Sweep and prune along X, suited to long horizontal levels. Proxies are
+// kept sorted by their min-X endpoint across frames; bodies barely move
+// between frames, so an insertion sort restores the order in close to linear
+// time. A sweep then only compares each proxy with the ones whose min-X
+// falls inside its X extent. New bodies are sorted separately and merged in,
+// so loading a level does not degrade the insertion sort.
+class SweepAndPrune : public Broadphase {
+public:
+    const char* name() const override { return "sweep_and_prune"; }
+    
+    // Element moves made by the insertion sort since startup
+    std::size_t swaps() const { return m_swaps; }
+    
+    void query(const Aabb& box, std::vector<std::uint32_t>& out) const override {
+        const std::size_t first = out.size();
+        
+        // Nothing wider than m_maxWidth can start further left and still reach the box
+        auto it = std::lower_bound(m_sorted.begin(), m_sorted.end(), box.minX - m_maxWidth,
+                                   [](const Endpoint& e, float x) { return e.minX < x; });
+        for(; it != m_sorted.end() && it->minX < box.maxX; ++it) {
+            if(m_proxies[it->index].bounds.overlaps(box)) out.push_back(it->index);
+        }
+        std::sort(out.begin() + first, out.end());
+    }
+    
+protected:
+    void rebuild() override {
+        m_frame++;
+        for(std::uint32_t i = 0; i < m_proxies.size(); ++i) {
+            const std::size_t slot = m_proxies[i].handle.index();
+            if(slot >= m_slotProxy.size()) m_slotProxy.resize(slot + 1);
+            m_slotProxy[slot] = { i, m_frame };
+        }
+        
+        // Keep last frame's order for bodies still present, at their new positions
+        m_placed.assign(m_proxies.size(), 0);
+        std::size_t kept = 0;
+        for(const Endpoint& endpoint : m_sorted) {
+            const std::size_t slot = endpoint.handle.index();
+            if(slot >= m_slotProxy.size() || m_slotProxy[slot].frame != m_frame) continue;
+            const std::uint32_t index = m_slotProxy[slot].index;
+            if(m_proxies[index].handle != endpoint.handle) continue;
+            m_sorted[kept++] = { m_proxies[index].bounds.minX, index, endpoint.handle };
+            m_placed[index] = 1;
+        }
+        m_sorted.resize(kept);
+        insertionSort();
+        
+        // New bodies: sort them on their own, then merge
+        for(std::uint32_t i = 0; i < m_proxies.size(); ++i) {
+            if(!m_placed[i]) m_sorted.push_back({ m_proxies[i].bounds.minX, i, m_proxies[i].handle });
+        }
+        if(m_sorted.size() > kept) {
+            std::sort(m_sorted.begin() + kept, m_sorted.end(), byMinX);
+            std::inplace_merge(m_sorted.begin(), m_sorted.begin() + kept, m_sorted.end(), byMinX);
+        }
+        
+        m_maxWidth = 0;
+        for(const BroadphaseProxy& proxy : m_proxies) {
+            m_maxWidth = std::max(m_maxWidth, proxy.bounds.maxX - proxy.bounds.minX);
+        }
+    }
+    
+    void findPairs(std::vector<BroadphasePair>& out) const override {
+        for(std::size_t i = 0; i < m_sorted.size(); ++i) {
+            const Aabb& a = m_proxies[m_sorted[i].index].bounds;
+            for(std::size_t j = i + 1; j < m_sorted.size() && m_sorted[j].minX < a.maxX; ++j) {
+                if(!a.overlaps(m_proxies[m_sorted[j].index].bounds)) continue;
+                const std::uint32_t first = m_sorted[i].index;
+                const std::uint32_t second = m_sorted[j].index;
+                if(!canCollide(m_proxies[first], m_proxies[second])) continue;
+                out.push_back({ std::min(first, second), std::max(first, second) });
+            }
+        }
+    }
+    
+private:
+    struct Endpoint {
+        float minX;
+        std::uint32_t index;
+        EntityHandle handle;
+    };
+    
+    struct SlotProxy {
+        std::uint32_t index = 0;
+        std::uint32_t frame = 0;
+    };
+    
+    static bool byMinX(const Endpoint& a, const Endpoint& b) { return a.minX < b.minX; }
+    
+    void insertionSort() {
+        for(std::size_t i = 1; i < m_sorted.size(); ++i) {
+            const Endpoint moving = m_sorted[i];
+            std::size_t j = i;
+            while(j > 0 && m_sorted[j - 1].minX > moving.minX) {
+                m_sorted[j] = m_sorted[j - 1];
+                --j;
+                m_swaps++;
+            }
+            m_sorted[j] = moving;
+        }
+    }
+    
+    std::vector<Endpoint> m_sorted;
+    std::vector<SlotProxy> m_slotProxy;  // by handle slot index, stamped with the frame
+    std::vector<std::uint8_t> m_placed;
+    float m_maxWidth = 0;
+    std::uint32_t m_frame = 0;
+    std::size_t m_swaps = 0;
+};
+
+// Keeps every moving body as a proxy in box2d's dynamic AABB tree across
+// frames. Each proxy is stored with a fattened box, so a body only goes back
+// into the tree once it leaves that box rather than every time it moves.
+// Proxies are keyed by entity handle, and those of bodies that disappear
+// (destroyed, or no longer dynamic) are removed at the next build().
+class DynamicTreeBroadphase : public Broadphase {
+public:
+    static constexpr float kFatMargin = 16.0f;
+    
+    DynamicTreeBroadphase() : m_tree(b2DynamicTree_Create()) {}
+    ~DynamicTreeBroadphase() override { b2DynamicTree_Destroy(&m_tree); }
+    DynamicTreeBroadphase(const DynamicTreeBroadphase&) = delete;
+    DynamicTreeBroadphase& operator=(const DynamicTreeBroadphase&) = delete;
+    
+    const char* name() const override { return "b2DynamicTree"; }
+    
+    // Proxies re-inserted since startup; low relative to bodies x frames means the fat boxes work
+    std::size_t reinsertions() const { return m_reinsertions; }
+    
+    void query(const Aabb& box, std::vector<std::uint32_t>& out) const override {
+        const std::size_t first = out.size();
+        QueryContext context{ this, &box, &out };
+        b2DynamicTree_Query(&m_tree, toB2(box), UINT64_MAX, &onQueryHit, &context);
+        std::sort(out.begin() + first, out.end());
+    }
+    
+protected:
+    void rebuild() override {
+        m_frame++;
+        for(std::uint32_t i = 0; i < m_proxies.size(); ++i) {
+            const Aabb& tight = m_proxies[i].bounds;
+            auto inserted = m_entries.try_emplace(m_proxies[i].handle.value);
+            TreeEntry& entry = inserted.first->second;
+            
+            if(inserted.second) {
+                entry.fat = tight.expanded(kFatMargin);
+                entry.proxyId = b2DynamicTree_CreateProxy(&m_tree, toB2(entry.fat), 1,
+                                                          static_cast<UserData>(m_proxies[i].handle.value));
+            } else if(!entry.fat.contains(tight)) {
+                entry.fat = tight.expanded(kFatMargin);
+                b2DynamicTree_MoveProxy(&m_tree, entry.proxyId, toB2(entry.fat));
+                m_reinsertions++;
+            }
+            entry.frame = m_frame;
+            
+            const std::size_t id = static_cast<std::size_t>(entry.proxyId);
+            if(id >= m_proxyToIndex.size()) m_proxyToIndex.resize(id + 1, kNoIndex);
+            m_proxyToIndex[id] = i;
+        }
+        
+        for(auto it = m_entries.begin(); it != m_entries.end();) {
+            if(it->second.frame != m_frame) {
+                b2DynamicTree_DestroyProxy(&m_tree, it->second.proxyId);
+                m_proxyToIndex[static_cast<std::size_t>(it->second.proxyId)] = kNoIndex;
+                it = m_entries.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    
+private:
+    // The proxy id and user data types of the query callback differ between
+    // box2d 3.x releases, so take them from the header rather than hard-coding
+    template<typename Fn>
+    struct TreeCallbackArgs;
+    
+    template<typename R, typename Id, typename User>
+    struct TreeCallbackArgs<R(Id, User, void*)> {
+        using ProxyId = Id;
+        using UserData = User;
+    };
+    
+    using ProxyId = typename TreeCallbackArgs<b2TreeQueryCallbackFcn>::ProxyId;
+    using UserData = typename TreeCallbackArgs<b2TreeQueryCallbackFcn>::UserData;
+    
+    static constexpr std::uint32_t kNoIndex = UINT32_MAX;
+    
+    struct TreeEntry {
+        int proxyId = -1;
+        Aabb fat{};
+        std::uint32_t frame = 0;
+    };
+    
+    struct QueryContext {
+        const DynamicTreeBroadphase* self;
+        const Aabb* box;
+        std::vector<std::uint32_t>* out;
+    };
+    
+    static bool onQueryHit(ProxyId proxyId, UserData, void* context) {
+        auto& query = *static_cast<QueryContext*>(context);
+        const std::uint32_t index = query.self->m_proxyToIndex[static_cast<std::size_t>(proxyId)];
+        // The tree matched the fat box; keep only real overlaps
+        if(index != kNoIndex && query.self->m_proxies[index].bounds.overlaps(*query.box)) {
+            query.out->push_back(index);
+        }
+        return true;  // keep going
+    }
+    
+    static b2AABB toB2(const Aabb& box) {
+        b2AABB result;
+        result.lowerBound = { box.minX, box.minY };
+        result.upperBound = { box.maxX, box.maxY };
+        return result;
+    }
+    
+    b2DynamicTree m_tree;
+    std::unordered_map<std::uint32_t, TreeEntry> m_entries;  // by EntityHandle value
+    std::vector<std::uint32_t> m_proxyToIndex;               // tree proxy id -> index into m_proxies
+    std::uint32_t m_frame = 0;
+    std::size_t m_reinsertions = 0;
+};
+
+// Broadphases the game can switch between at runtime
+enum class BroadphaseKind {
+    Naive,
+    Grid,
+    HierarchicalGrid,
+    DynamicTree,
+    SweepAndPrune,
+    Count
+};
+
+inline std::unique_ptr<Broadphase> createBroadphase(BroadphaseKind kind) {
+    switch(kind) {
+        case BroadphaseKind::Naive: return std::make_unique<NaiveBroadphase>();
+        case BroadphaseKind::DynamicTree: return std::make_unique<DynamicTreeBroadphase>();
+        case BroadphaseKind::SweepAndPrune: return std::make_unique<SweepAndPrune>();
+        case BroadphaseKind::HierarchicalGrid: return std::make_unique<HierarchicalGrid>();
+        case BroadphaseKind::Grid:
+        default: return std::make_unique<SpatialHashGrid>();
+    }
+}
+
+// Bounding volume hierarchy over the static level geometry, built once after
+// a level loads and never updated. Static bodies are most of a level, so
+// keeping them out of the per-frame rebuild leaves only moving bodies to pay
+// for each frame. Nodes are stored flat; each interior node splits its
+// proxies at the median of its longest axis. If the World's structure
+// changes (a platform is destroyed, or another entity's removal moves its
+// row), the proxies re-resolve their handles before the next query.
+class StaticBvh {
+public:
+    static StaticBvh& getInstance() {
+        static StaticBvh instance;
+        return instance;
+    }
+    
+    void build(World& world) {
+        m_proxies.clear();
+        m_nodes.clear();
+        m_order.clear();
+        world.view<BodyComponent, SolidComponent>().each([this](GameObject& obj, BodyComponent& body, SolidComponent&) {
+            if(isStaticBody(obj.mask())) {
+                applyDefaultCollisionLayer(obj.mask(), body);
+                m_proxies.push_back(makeProxy(Aabb::of(body), obj, body));
             }
+        });
+        
+        m_order.resize(m_proxies.size());
+        for(std::uint32_t i = 0; i < m_order.size(); ++i) m_order[i] = i;
+        if(!m_proxies.empty()) {
+            m_nodes.reserve(2 * m_proxies.size());
+            m_nodes.emplace_back();
+            buildNode(0, 0, static_cast<std::uint32_t>(m_proxies.size()));
         }
+        m_version = world.structureVersion();
+        m_geometryVersion = world.staticGeometryVersion();
         
-        void draw(SDL_Renderer* renderer, const View& view) override {
-            auto body = parent().get<BodyComponent>();
-            if(!body) return;
-            
-            SDL_Rect destRect = view.getTransformedRect(body->x, body->y, body->width, body->height);
-            
-            // If we have a texture, use it
-            if(m_texture) {
-                // For custom source rectangle (specific tile coordinates)
-                if(m_usingCustomSource) {
-                    SDL_RenderCopy(renderer, m_texture, &m_customSrcRect, &destRect);
-                }
-                // For sprite sheets with static frames (platforms)
-                else if(m_usingSpriteSheet && !m_animated) {
-                    // Calculate row and column for the static frame
-                    int row = m_currentFrame / m_framesPerRow;
-                    int col = m_currentFrame % m_framesPerRow;
-                    
-                    SDL_Rect srcRect = {
-                        m_spriteWidth * col,
-                        m_spriteHeight * row,
-                        m_spriteWidth,
-                        m_spriteHeight
-                    };
-                    SDL_RenderCopy(renderer, m_texture, &srcRect, &destRect);
-                }
-                // For animated sprite sheets (characters, enemies)
-                else if(m_usingSpriteSheet && m_animated) {
-                    int row = m_currentFrame / m_framesPerRow;
-                    int col = m_currentFrame % m_framesPerRow;
-                    
-                    SDL_Rect srcRect = {
-                        m_spriteWidth * col,
-                        m_spriteHeight * row,
-                        m_spriteWidth,
-                        m_spriteHeight
-                    };
-                    SDL_RenderCopy(renderer, m_texture, &srcRect, &destRect);
+        std::cout << "Static BVH: " << m_proxies.size() << " bodies, " << m_nodes.size() << " nodes" << std::endl;
+    }
+    
+    // Appends the indices of live static proxies overlapping 'box', ascending
+    void query(const Aabb& box, std::vector<std::uint32_t>& out) const {
+        if(m_nodes.empty()) return;
+        const std::size_t first = out.size();
+        
+        std::uint32_t stack[64];
+        int top = 0;
+        stack[top++] = 0;
+        while(top > 0) {
+            const Node& node = m_nodes[stack[--top]];
+            if(!node.bounds.overlaps(box)) continue;
+            if(node.count > 0) {
+                for(std::uint32_t i = node.first; i < node.first + node.count; ++i) {
+                    const std::uint32_t index = m_order[i];
+                    if(m_proxies[index].object && m_proxies[index].bounds.overlaps(box)) out.push_back(index);
                 }
-                // For static textures (stretched to fit)
-                else {
-                    SDL_RenderCopy(renderer, m_texture, NULL, &destRect);
+            } else {
+                stack[top++] = node.first;
+                stack[top++] = node.first + 1;
+            }
+        }
+        std::sort(out.begin() + first, out.end());
+    }
+    
+    // One walk of the tree for a packet of up to 64 queries, bit i standing
+    // for query i. cull(bounds, bits) returns the bits whose query may reach
+    // something inside 'bounds'; every live proxy it keeps is passed to
+    // visit(index, bits) with the queries that reach it.
+    template<typename Cull, typename Visit>
+    void traverse(std::uint64_t bits, Cull&& cull, Visit&& visit) const {
+        if(m_nodes.empty() || !bits) return;
+        
+        struct Entry {
+            std::uint32_t node;
+            std::uint64_t bits;
+        };
+        Entry stack[64];
+        int top = 0;
+        stack[top++] = { 0, bits };
+        while(top > 0) {
+            const Entry entry = stack[--top];
+            const Node& node = m_nodes[entry.node];
+            const std::uint64_t live = cull(node.bounds, entry.bits);
+            if(!live) continue;
+            if(node.count > 0) {
+                for(std::uint32_t i = node.first; i < node.first + node.count; ++i) {
+                    const std::uint32_t index = m_order[i];
+                    if(!m_proxies[index].object) continue;
+                    const std::uint64_t reached = cull(m_proxies[index].bounds, live);
+                    if(reached) visit(index, reached);
                 }
-            } 
-            // Otherwise fall back to colored rectangles
-            else {
-                SDL_SetRenderDrawColor(renderer, m_color.r, m_color.g, m_color.b, 255);
-                SDL_RenderFillRect(renderer, &destRect);
-                
-                SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-                SDL_RenderDrawRect(renderer, &destRect);
+            } else {
+                stack[top++] = { node.first, live };
+                stack[top++] = { node.first + 1, live };
             }
         }
+    }
+    
+    // Re-resolves proxy pointers if the World's structure changed since the
+    // last call. If level geometry was added since the build, e.g. a platform
+    // spawned through the command buffer after load, rebuilds the tree instead.
+    void refresh(World& world) {
+        if(m_geometryVersion != world.staticGeometryVersion()) {
+            build(world);
+            return;
+        }
+        if(m_version == world.structureVersion()) return;
         
-        // Texture management methods
-        void setTexture(SDL_Texture* texture) { 
-            m_texture = texture; 
+        m_version = world.structureVersion();
+        for(BroadphaseProxy& proxy : m_proxies) {
+            GameObject* obj = world.resolve(proxy.handle);
+            if(obj && isStaticBody(obj->mask()) && obj->has<BodyComponent>()) {
+                proxy.object = obj;
+                proxy.body = obj->get<BodyComponent>();
+            } else {
+                proxy.object = nullptr;  // gone: skipped by queries until the next build
+                proxy.body = nullptr;
+            }
         }
+    }
+    
+    const BroadphaseProxy& proxy(std::uint32_t index) const { return m_proxies[index]; }
+    std::size_t proxyCount() const { return m_proxies.size(); }
+    
+private:
+    static constexpr std::uint32_t kLeafSize = 4;
+    
+    // Leaves have count > 0 and cover m_order[first, first + count);
+    // interior nodes have count == 0 and children at first and first + 1
+    struct Node {
+        Aabb bounds;
+        std::uint32_t first;
+        std::uint32_t count;
+    };
+    
+    StaticBvh() = default;
+    
+    // Fills node 'nodeIndex' (already allocated) from m_order[begin, end)
+    void buildNode(std::uint32_t nodeIndex, std::uint32_t begin, std::uint32_t end) {
+        Aabb bounds = m_proxies[m_order[begin]].bounds;
+        for(std::uint32_t i = begin + 1; i < end; ++i) {
+            const Aabb& b = m_proxies[m_order[i]].bounds;
+            bounds = { std::min(bounds.minX, b.minX), std::min(bounds.minY, b.minY),
+                       std::max(bounds.maxX, b.maxX), std::max(bounds.maxY, b.maxY) };
+        }
+        m_nodes[nodeIndex].bounds = bounds;
         
-        // For multi-row sprite sheets
-        void setSpriteSheet(int frameWidth, int frameHeight, int totalFrames, int framesPerRow, float frameRate = 10.0f) {
-            m_usingSpriteSheet = true;
-            m_spriteWidth = frameWidth;
-            m_spriteHeight = frameHeight;
-            m_totalFrames = totalFrames;
-            m_framesPerRow = framesPerRow;
-            m_frameDuration = 1.0f / frameRate;
-            m_animated = true;
-            
-            std::cout << "Sprite sheet configured: " << frameWidth << "x" << frameHeight 
-                      << ", " << totalFrames << " frames, " << framesPerRow << " per row" << std::endl;
+        if(end - begin <= kLeafSize) {
+            m_nodes[nodeIndex].first = begin;
+            m_nodes[nodeIndex].count = end - begin;
+            return;
         }
         
-        // For single-row sprite sheets (backward compatibility)
-        void setSpriteSheet(int frameWidth, int frameHeight, int totalFrames, float frameRate = 10.0f) {
-            setSpriteSheet(frameWidth, frameHeight, totalFrames, totalFrames, frameRate);
+        // Median split on the longest axis, by box centre
+        const bool splitX = (bounds.maxX - bounds.minX) >= (bounds.maxY - bounds.minY);
+        const std::uint32_t mid = begin + (end - begin) / 2;
+        std::nth_element(m_order.begin() + begin, m_order.begin() + mid, m_order.begin() + end,
+                         [this, splitX](std::uint32_t a, std::uint32_t b) {
+                             const Aabb& ba = m_proxies[a].bounds;
+                             const Aabb& bb = m_proxies[b].bounds;
+                             return splitX ? (ba.minX + ba.maxX) < (bb.minX + bb.maxX)
+                                           : (ba.minY + ba.maxY) < (bb.minY + bb.maxY);
+                         });
+        
+        // Children are allocated as a pair so the parent only stores the first
+        const std::uint32_t left = static_cast<std::uint32_t>(m_nodes.size());
+        m_nodes.emplace_back();
+        m_nodes.emplace_back();
+        m_nodes[nodeIndex].first = left;
+        m_nodes[nodeIndex].count = 0;
+        buildNode(left, begin, mid);
+        buildNode(left + 1, mid, end);
+    }
+    
+    std::vector<BroadphaseProxy> m_proxies;
+    std::vector<std::uint32_t> m_order;
+    std::vector<Node> m_nodes;
+    std::uint64_t m_version = 0;
+    std::uint64_t m_geometryVersion = 0;
+};
+
+// ========================
+// Tile Collision Layer
+// ========================
+// Level geometry authored as a grid of square tiles, one bit per cell, for
+// levels too large to give every tile a GameObject. The cells under a box
+// are found by index math, so resolving a body costs the cells it touches
+// however big the grid is. Bodies are moved one axis at a time from where
+// they started the frame, which also keeps them from catching on the seams
+// between the tiles of a floor or wall. Loaded with the level and only read
+// afterwards, so contact tasks may resolve against it in parallel.
+class TileCollisionLayer {
+public:
+    static TileCollisionLayer& getInstance() {
+        static TileCollisionLayer instance;
+        return instance;
+    }
+    
+    // Faces of solid cells a body was stopped by, at most one per axis
+    struct Contact {
+        ContactNormal alongX = ContactNormal::None;
+        ContactNormal alongY = ContactNormal::None;
+    };
+    
+    // Replaces the grid with 'rows', top to bottom: '.' and ' ' are empty
+    // cells, any other character a solid one. Cell (0, 0) has its top left
+    // corner at (originX, originY).
+    void load(float originX, float originY, float tileSize, const std::vector<std::string>& rows) {
+        clear();
+        if(rows.empty() || tileSize <= 0) return;
+        
+        m_originX = originX;
+        m_originY = originY;
+        m_tileSize = tileSize;
+        m_height = static_cast<int>(rows.size());
+        for(const std::string& row : rows) m_width = std::max(m_width, static_cast<int>(row.size()));
+        m_wordsPerRow = (m_width + 63) / 64;
+        m_bits.assign(std::size_t(m_wordsPerRow) * m_height, 0);
+        
+        for(int row = 0; row < m_height; ++row) {
+            for(int column = 0; column < static_cast<int>(rows[row].size()); ++column) {
+                const char cell = rows[row][column];
+                if(cell == '.' || cell == ' ') continue;
+                m_bits[std::size_t(row) * m_wordsPerRow + column / 64] |= std::uint64_t(1) << (column % 64);
+                ++m_solidCount;
+            }
         }
         
-        void setStaticFrame(int frame) {
-            m_currentFrame = frame;
-            m_animated = false; // Don't animate platforms
+        std::cout << "Tile layer: " << m_width << "x" << m_height << " cells, " << m_solidCount << " solid" << std::endl;
+    }
+    
+    void clear() {
+        m_bits.clear();
+        m_width = m_height = m_wordsPerRow = 0;
+        m_solidCount = 0;
+    }
+    
+    // Tileset cell drawn for every solid cell
+    void setAppearance(const std::string& textureKey, int tileX, int tileY, int tileWidth, int tileHeight) {
+        m_textureKey = textureKey;
+        m_sourceRect = { tileX * tileWidth, tileY * tileHeight, tileWidth, tileHeight };
+    }
+    
+    bool empty() const { return m_solidCount == 0; }
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    std::size_t solidCount() const { return m_solidCount; }
+    
+    // Cells outside the grid are empty
+    bool solid(int column, int row) const {
+        if(column < 0 || row < 0 || column >= m_width || row >= m_height) return false;
+        return (m_bits[std::size_t(row) * m_wordsPerRow + column / 64] >> (column % 64)) & 1;
+    }
+    
+    // Moves 'body' from (prevX, prevY) to where it is now one axis at a
+    // time, stopping at the first solid cell it would enter: along x with
+    // the rows it started in, then along y with the columns it ended up in.
+    // Cells it already overlapped at the start are passed through, so a
+    // body placed inside the grid can get out. A stop zeroes that velocity.
+    Contact resolve(BodyComponent& body) const {
+        Contact contact;
+        if(empty()) return contact;
+        
+        const float dx = body.x - body.prevX;
+        const float dy = body.y - body.prevY;
+        float face;
+        
+        const CellRange rows = cellsOverlapping(body.prevY, body.prevY + body.height, m_originY, m_height, kSkin);
+        auto columnBlocked = [&](int column) {
+            for(int row = rows.first; row <= rows.last; ++row) {
+                if(solid(column, row)) return true;
+            }
+            return false;
+        };
+        if(dx != 0 && !rows.empty() && firstEntered(body.prevX, body.prevX + body.width, dx, m_originX, m_width, columnBlocked, face)) {
+            body.x = dx > 0 ? face - body.width : face;
+            body.velocityX = 0;
+            contact.alongX = dx > 0 ? ContactNormal::Left : ContactNormal::Right;
+        }
+        
+        const CellRange columns = cellsOverlapping(body.x, body.x + body.width, m_originX, m_width, kSkin);
+        auto rowBlocked = [&](int row) {
+            for(int word = columns.first / 64; word <= columns.last / 64; ++word) {
+                if(rowBits(row, word, columns)) return true;
+            }
+            return false;
+        };
+        if(dy != 0 && !columns.empty() && firstEntered(body.prevY, body.prevY + body.height, dy, m_originY, m_height, rowBlocked, face)) {
+            body.y = dy > 0 ? face - body.height : face;
+            body.velocityY = 0;
+            contact.alongY = dy > 0 ? ContactNormal::Top : ContactNormal::Bottom;
         }
+        return contact;
+    }
     
-        // Set specific tile from the sprite sheet
-        void setTile(int tileX, int tileY, int tileWidth, int tileHeight) {
-            m_usingSpriteSheet = true;
-            m_spriteWidth = tileWidth;
-            m_spriteHeight = tileHeight;
-            
-            // For platforms, we don't use frame calculation - we use direct source rectangle
-            m_usingCustomSource = true;
-            m_customSrcRect = {
-                tileX * tileWidth,
-                tileY * tileHeight,
-                tileWidth,
-                tileHeight
-            };
-            
-            m_animated = false; // Static for platforms
-            m_totalFrames = 1; // Only using one frame
+    // Earliest time before maxTime at which 'box', moving by (dx, dy), hits
+    // a face of a solid cell, as sweepAabb reports it. Only faces between a
+    // solid and an empty cell count, so a box sliding along a floor does not
+    // catch on the seams between its tiles.
+    bool sweep(const Aabb& box, float dx, float dy, float maxTime, SweepHit& hit) const {
+        if(empty()) return false;
+        
+        bool found = false;
+        const CellRange rows = cellsOverlapping(std::min(box.minY, box.minY + dy), std::max(box.maxY, box.maxY + dy),
+                                                m_originY, m_height, 0);
+        for(int row = rows.first; row <= rows.last; ++row) {
+            // Part of the move the box spends level with this row
+            const float top = m_originY + row * m_tileSize;
+            float entry, exit;
+            if(!sweepSlab(box.minY, box.maxY, top, top + m_tileSize, dy, entry, exit)) continue;
+            entry = std::max(entry, 0.0f);
+            exit = std::min(exit, found ? hit.time : maxTime);
+            if(entry >= exit) continue;
             
-            std::cout << "Tile set to: (" << tileX << "," << tileY << ") at position (" 
-                      << m_customSrcRect.x << "," << m_customSrcRect.y << ")" << std::endl;
+            const float x0 = box.minX + dx * entry;
+            const float x1 = box.minX + dx * exit;
+            const CellRange columns = cellsOverlapping(std::min(x0, x1), std::max(x0, x1) + (box.maxX - box.minX),
+                                                       m_originX, m_width, 0);
+            if(columns.empty()) continue;
+            for(int word = columns.first / 64; word <= columns.last / 64; ++word) {
+                for(std::uint64_t bits = rowBits(row, word, columns); bits; bits &= bits - 1) {
+                    const int column = word * 64 + static_cast<int>(lowestSetBit64(bits));
+                    const float left = m_originX + column * m_tileSize;
+                    SweepHit cellHit;
+                    if(!sweepAabb(box, dx, dy, { left, top, left + m_tileSize, top + m_tileSize }, cellHit)) continue;
+                    if(cellHit.time >= (found ? hit.time : maxTime)) continue;
+                    
+                    const bool exposed = cellHit.alongX ? !solid(dx > 0 ? column - 1 : column + 1, row)
+                                                        : !solid(column, dy > 0 ? row - 1 : row + 1);
+                    if(!exposed) continue;
+                    hit = cellHit;
+                    found = true;
+                }
+            }
         }
+        return found;
+    }
     
-        // Set specific source rectangle directly
-        void setSourceRect(int x, int y, int width, int height) {
-            m_usingCustomSource = true;
-            m_customSrcRect = {x, y, width, height};
-            m_animated = false;
-        }
+    // Draws the solid cells in view with the tileset cell from
+    // setAppearance, or as plain boxes if that texture is missing
+    void draw(SDL_Renderer* renderer, const View& view) const {
+        if(empty()) return;
         
-    private:
-        std::string m_textureKey;
-        SDL_Color m_color;
-        SDL_Texture* m_texture;
-        SDL_Rect m_customSrcRect = {0, 0, 0, 0};
+        const CellRange columns = cellsOverlapping(view.screenToWorldX(0), view.screenToWorldX(static_cast<float>(view.screenWidth())),
+                                                   m_originX, m_width, 0);
+        const CellRange rows = cellsOverlapping(view.screenToWorldY(0), view.screenToWorldY(static_cast<float>(view.screenHeight())),
+                                                m_originY, m_height, 0);
+        if(columns.empty()) return;
+        SDL_Texture* texture = m_textureKey.empty() ? nullptr : TextureManager::getInstance().getTexture(m_textureKey);
+        
+        for(int row = rows.first; row <= rows.last; ++row) {
+            for(int word = columns.first / 64; word <= columns.last / 64; ++word) {
+                for(std::uint64_t bits = rowBits(row, word, columns); bits; bits &= bits - 1) {
+                    const int column = word * 64 + static_cast<int>(lowestSetBit64(bits));
+                    SDL_Rect destRect = view.getTransformedRect(m_originX + column * m_tileSize, m_originY + row * m_tileSize,
+                                                                m_tileSize, m_tileSize);
+                    if(texture) {
+                        SDL_RenderCopy(renderer, texture, &m_sourceRect, &destRect);
+                    } else {
+                        SDL_SetRenderDrawColor(renderer, 128, 128, 128, 255);
+                        SDL_RenderFillRect(renderer, &destRect);
+                        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+                        SDL_RenderDrawRect(renderer, &destRect);
+                    }
+                }
+            }
+        }
+    }
     
-        // Sprite sheet animation properties
-        bool m_usingSpriteSheet = false;
-        bool m_animated = false;
-        int m_spriteWidth = 0;
-        int m_spriteHeight = 0;
-        int m_totalFrames = 1;
-        int m_framesPerRow = 1;  // frames per row for multi-row sheets
-        int m_currentFrame = 0;
-        float m_animationTimer = 0.0f;
-        float m_frameDuration = 0.1f;
-        bool m_usingCustomSource = false;
+private:
+    // Shaved off both ends of a body before finding its cells, so a body
+    // resting exactly on a tile does not count as inside it through rounding
+    static constexpr float kSkin = 0.05f;
+    
+    // Cells [first, last] on one axis
+    struct CellRange {
+        int first, last;
+        
+        bool empty() const { return first > last; }
     };
+    
+    TileCollisionLayer() = default;
+    
+    // Index of the cell holding 'offset' cells from the origin, clamped to
+    // [-1, count] so far-off coordinates do not overflow
+    static int cellIndex(float offset, int count) {
+        if(offset < -1) return -1;
+        if(offset > count) return count;
+        return static_cast<int>(offset);
+    }
+    
+    // Cells of the grid that the open extent (lo + skin, hi - skin) overlaps
+    CellRange cellsOverlapping(float lo, float hi, float origin, int count, float skin) const {
+        const int first = cellIndex(std::floor((lo + skin - origin) / m_tileSize), count);
+        const int last = cellIndex(std::ceil((hi - skin - origin) / m_tileSize), count) - 1;
+        return { std::max(first, 0), std::min(last, count - 1) };
+    }
+    
+    // Bits of row 'row' in 'word' that lie within 'columns'
+    std::uint64_t rowBits(int row, int word, const CellRange& columns) const {
+        std::uint64_t bits = m_bits[std::size_t(row) * m_wordsPerRow + word];
+        if(word == columns.first / 64) bits &= ~std::uint64_t(0) << (columns.first % 64);
+        if(word == columns.last / 64) bits &= ~std::uint64_t(0) >> (63 - columns.last % 64);
+        return bits;
+    }
+    
+    // Walks the cells an extent [lo, hi] moving by d enters on one axis,
+    // nearest first, skipping those it starts in. On the first that is
+    // blocked, sets 'face' to the side of it the extent meets.
+    template<typename Blocked>
+    bool firstEntered(float lo, float hi, float d, float origin, int count, Blocked&& blocked, float& face) const {
+        if(d > 0) {
+            const int first = std::max(cellIndex(std::ceil((hi - kSkin - origin) / m_tileSize), count), 0);
+            const int last = std::min(cellIndex(std::ceil((hi + d - origin) / m_tileSize), count) - 1, count - 1);
+            for(int i = first; i <= last; ++i) {
+                if(blocked(i)) {
+                    face = origin + i * m_tileSize;
+                    return true;
+                }
+            }
+        } else {
+            const int first = std::min(cellIndex(std::floor((lo + kSkin - origin) / m_tileSize), count) - 1, count - 1);
+            const int last = std::max(cellIndex(std::floor((lo + d - origin) / m_tileSize), count), 0);
+            for(int i = first; i >= last; --i) {
+                if(blocked(i)) {
+                    face = origin + (i + 1) * m_tileSize;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+    
+    std::vector<std::uint64_t> m_bits;  // row-major, m_wordsPerRow words per row
+    int m_width = 0, m_height = 0;
+    int m_wordsPerRow = 0;
+    std::size_t m_solidCount = 0;
+    float m_originX = 0, m_originY = 0;
+    float m_tileSize = 16;
+    std::string m_textureKey;
+    SDL_Rect m_sourceRect = { 0, 0, 16, 16 };
+};
 
 // ========================
-// Collision System
+// Scene Queries
 // ========================
-class CollisionSystem {
+// Ray casts, box casts and box overlap tests against the collidable bodies,
+// for AI and ground probes. Level geometry comes from the StaticBvh and the
+// TileCollisionLayer, and moving bodies from the Game's broadphase as of its
+// last collision pass. Casts stop at tiles on the solid layer; overlapBox
+// only reports bodies.
+// Those are looked for with kContactMargin to spare, for the motion since,
+// and the exact test uses their bounds now. A cast that starts inside a body does not hit it, so
+// a probe from an entity's own body ignores that body. Queries only read:
+// systems may run them in parallel if they declare a read of BodyComponent.
+class SceneQuery {
 public:
-    static bool checkCollision(BodyComponent* a, BodyComponent* b) {
-        return (a->x < b->x + b->width &&
-                a->x + a->width > b->x &&
-                a->y < b->y + b->height &&
-                a->y + a->height > b->y);
+    static SceneQuery& getInstance() {
+        static SceneQuery instance;
+        return instance;
     }
-
-    static bool resolvePlatformCollision(BodyComponent* player, BodyComponent* platform, float platformVelocityX) {
-        // Calculate overlap in all directions
-        float overlapLeft = (player->x + player->width) - platform->x;
-        float overlapRight = (platform->x + platform->width) - player->x;
-        float overlapTop = (player->y + player->height) - platform->y;
-        float overlapBottom = (platform->y + platform->height) - player->y;
-
-        // Find the smallest overlap
-        bool fromLeft = std::abs(overlapLeft) < std::abs(overlapRight);
-        bool fromTop = std::abs(overlapTop) < std::abs(overlapBottom);
-
-        float minOverlapX = fromLeft ? overlapLeft : overlapRight;
-        float minOverlapY = fromTop ? overlapTop : overlapBottom;
-
-        // Resolve in the direction of least overlap
-        if(std::abs(minOverlapX) < std::abs(minOverlapY)) {
-            // Horizontal collision
-            if(fromLeft) {
-                player->x = platform->x - player->width;
-            } else {
-                player->x = platform->x + platform->width;
+    
+    // Segment from (x, y) to (x + dx, y + dy), hitting bodies on 'mask'
+    struct Ray {
+        float x, y, dx, dy;
+        LayerMask mask;
+    };
+    
+    struct Hit {
+        EntityHandle handle;
+        GameObject* object = nullptr;                // null when nothing, or a tile, was hit
+        float fraction = 1;                          // how far along the cast it hit
+        float x = 0, y = 0;                          // ray point, or box min corner, at the hit
+        ContactNormal normal = ContactNormal::None;  // face of the body that was hit
+    };
+    
+    // Set by the Game whenever it replaces its broadphase
+    void setBroadphase(const Broadphase* broadphase) { m_broadphase = broadphase; }
+    
+    // Closest body on 'mask' along the segment from (x0, y0) to (x1, y1)
+    bool raycast(float x0, float y0, float x1, float y1, LayerMask mask, Hit& hit) const {
+        return boxcast({ x0, y0, x0, y0 }, x1 - x0, y1 - y0, mask, hit);
+    }
+    
+    // Closest body on 'mask' that 'box' runs into moving by (dx, dy)
+    bool boxcast(const Aabb& box, float dx, float dy, LayerMask mask, Hit& hit) const {
+        const Cast cast{ box, dx, dy, mask };
+        hit = Hit();
+        castPacket(&cast, 1, &hit);
+        return hit.fraction < 1;
+    }
+    
+    // Appends the bodies on 'mask' overlapping 'box'
+    void overlapBox(const Aabb& box, LayerMask mask, std::vector<GameObject*>& out) const {
+        const World& world = World::getInstance();
+        auto test = [&](const BroadphaseProxy& proxy) {
+            if(!(proxy.layer & mask)) return;
+            GameObject* obj = world.resolve(proxy.handle);
+            if(obj && obj->has<BodyComponent>() && Aabb::of(*obj->get<BodyComponent>()).overlaps(box)) out.push_back(obj);
+        };
+        
+        std::vector<std::uint32_t> candidates;
+        const StaticBvh& statics = StaticBvh::getInstance();
+        statics.query(box, candidates);
+        for(std::uint32_t index : candidates) test(statics.proxy(index));
+        
+        if(!m_broadphase) return;
+        candidates.clear();
+        m_broadphase->query(box.expanded(Broadphase::kContactMargin), candidates);
+        for(std::uint32_t index : candidates) test(m_broadphase->proxy(index));
+    }
+    
+    // Closest hit of every ray; hits[i] answers rays[i]. Rays are sorted by
+    // origin into packets of kPacketSize, and each packet walks the static
+    // tree and queries the broadphase once for all of its rays.
+    void raycastBatch(const std::vector<Ray>& rays, std::vector<Hit>& hits) const {
+        hits.assign(rays.size(), Hit());
+        
+        std::vector<std::uint32_t> order(rays.size());
+        for(std::uint32_t i = 0; i < order.size(); ++i) order[i] = i;
+        std::sort(order.begin(), order.end(), [&rays](std::uint32_t a, std::uint32_t b) {
+            return rays[a].x != rays[b].x ? rays[a].x < rays[b].x : rays[a].y < rays[b].y;
+        });
+        
+        std::array<Cast, kPacketSize> casts;
+        std::array<Hit, kPacketSize> packetHits;
+        for(std::size_t first = 0; first < order.size(); first += kPacketSize) {
+            const std::size_t count = std::min(kPacketSize, order.size() - first);
+            for(std::size_t k = 0; k < count; ++k) {
+                const Ray& ray = rays[order[first + k]];
+                casts[k] = { { ray.x, ray.y, ray.x, ray.y }, ray.dx, ray.dy, ray.mask };
+                packetHits[k] = Hit();
             }
-            player->velocityX = 0;
-            return false;
-        } else {
-            // Vertical collision
-            if(fromTop) {
-                player->y = platform->y - player->height;
-                player->velocityY = 0;
-                
-                // NEW: Carry player with moving platform
-                if(std::abs(platformVelocityX) > 0.1f) {
-                    player->x += platformVelocityX;
-                }
-                
-                // Player is on top of platform
-                return true;
-            } else {
-                player->y = platform->y + platform->height;
-                player->velocityY = 0;
-                return false;
+            castPacket(casts.data(), count, packetHits.data());
+            for(std::size_t k = 0; k < count; ++k) {
+                hits[order[first + k]] = packetHits[k];
+            }
+        }
+    }
+    
+private:
+    static constexpr std::size_t kPacketSize = 64;  // one bit each in a traversal mask
+    
+    struct Cast {
+        Aabb box;
+        float dx, dy;
+        LayerMask mask;
+    };
+    
+    SceneQuery() = default;
+    
+    static ContactNormal faceHit(const SweepHit& sweep, float dx, float dy) {
+        if(sweep.alongX) return dx > 0 ? ContactNormal::Left : ContactNormal::Right;
+        return dy > 0 ? ContactNormal::Top : ContactNormal::Bottom;
+    }
+    
+    // Keeps the closest hit of each of 'count' casts in hits[], which start
+    // out empty or hold a hit to beat
+    void castPacket(const Cast* casts, std::size_t count, Hit* hits) const {
+        const World& world = World::getInstance();
+        const std::uint64_t all = count == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << count) - 1;
+        
+        // Casts whose sweep reaches 'bounds' before their closest hit so far
+        auto cull = [&](const Aabb& bounds, std::uint64_t bits) {
+            std::uint64_t live = 0;
+            for(; bits; bits &= bits - 1) {
+                const std::size_t i = lowestSetBit64(bits);
+                const Cast& cast = casts[i];
+                if(sweepReaches(cast.box, cast.dx, cast.dy, bounds, hits[i].fraction)) live |= std::uint64_t(1) << i;
+            }
+            return live;
+        };
+        
+        auto test = [&](const BroadphaseProxy& proxy, std::uint64_t bits) {
+            GameObject* obj = world.resolve(proxy.handle);
+            if(!obj || !obj->has<BodyComponent>()) return;
+            const Aabb target = Aabb::of(*obj->get<BodyComponent>());
+            for(; bits; bits &= bits - 1) {
+                const std::size_t i = lowestSetBit64(bits);
+                const Cast& cast = casts[i];
+                SweepHit sweep;
+                if(!(proxy.layer & cast.mask) || !sweepAabb(cast.box, cast.dx, cast.dy, target, sweep)) continue;
+                if(sweep.time >= hits[i].fraction) continue;
+                hits[i] = { proxy.handle, obj, sweep.time, cast.box.minX + cast.dx * sweep.time,
+                            cast.box.minY + cast.dy * sweep.time, faceHit(sweep, cast.dx, cast.dy) };
             }
+        };
+        
+        const StaticBvh& statics = StaticBvh::getInstance();
+        statics.traverse(all, cull, [&](std::uint32_t index, std::uint64_t bits) { test(statics.proxy(index), bits); });
+        
+        const TileCollisionLayer& tiles = TileCollisionLayer::getInstance();
+        for(std::size_t i = 0; i < count; ++i) {
+            const Cast& cast = casts[i];
+            SweepHit sweep;
+            if(!(cast.mask & layerBit(CollisionLayer::Solid))) continue;
+            if(!tiles.sweep(cast.box, cast.dx, cast.dy, hits[i].fraction, sweep)) continue;
+            hits[i] = { EntityHandle(), nullptr, sweep.time, cast.box.minX + cast.dx * sweep.time,
+                        cast.box.minY + cast.dy * sweep.time, faceHit(sweep, cast.dx, cast.dy) };
+        }
+        
+        if(!m_broadphase) return;
+        Aabb bounds = casts[0].box;
+        for(std::size_t i = 0; i < count; ++i) {
+            const Cast& cast = casts[i];
+            bounds = { std::min({ bounds.minX, cast.box.minX, cast.box.minX + cast.dx }),
+                       std::min({ bounds.minY, cast.box.minY, cast.box.minY + cast.dy }),
+                       std::max({ bounds.maxX, cast.box.maxX, cast.box.maxX + cast.dx }),
+                       std::max({ bounds.maxY, cast.box.maxY, cast.box.maxY + cast.dy }) };
+        }
+        std::vector<std::uint32_t> candidates;
+        m_broadphase->query(bounds.expanded(Broadphase::kContactMargin), candidates);
+        for(std::uint32_t index : candidates) {
+            const BroadphaseProxy& proxy = m_broadphase->proxy(index);
+            // Padded like the query, as bodies may have moved since the build
+            if(const std::uint64_t live = cull(proxy.bounds.expanded(Broadphase::kContactMargin), all)) test(proxy, live);
         }
     }
+    
+    const Broadphase* m_broadphase = nullptr;
 };
 
 // ControllerComponent (handles input + physics for player)
-class ControllerComponent : public Component {
+class ControllerComponent final : public Component {
 public:
+    static constexpr ComponentCaps kCaps = kCapsUpdate;
+    
     void update(float dt) override {
         auto body = parent().get<BodyComponent>();
         if(!body) return;
@@ -704,7 +3729,7 @@ public:
             body->velocityY = -jumpForce;
             m_grounded = false;
             m_onPlatform = false;
-            m_attachedPlatform = nullptr;
+            m_attachedPlatform = EntityHandle();
         }
         
         // Apply gravity
@@ -713,9 +3738,10 @@ public:
         // Update position
         body->y += body->velocityY * dt;
         
-        // If attached to a platform, move with it
-        if(m_attachedPlatform) {
-            auto platformBody = m_attachedPlatform->get<BodyComponent>();
+        // If attached to a platform, move with it (resolves to nullptr if it was destroyed)
+        GameObject* platform = World::getInstance().resolve(m_attachedPlatform);
+        if(platform) {
+            auto platformBody = platform->get<BodyComponent>();
             if(platformBody) {
                 float platformDeltaX = platformBody->x - m_lastPlatformX;
                 body->x += platformDeltaX;
@@ -726,8 +3752,8 @@ public:
         }
         
         // Store current platform position for next frame
-        if(m_attachedPlatform) {
-            auto platformBody = m_attachedPlatform->get<BodyComponent>();
+        if(platform) {
+            auto platformBody = platform->get<BodyComponent>();
             if(platformBody) {
                 m_lastPlatformX = platformBody->x;
             }
@@ -743,35 +3769,38 @@ public:
         }
     }
     
-    void draw(SDL_Renderer* renderer, const View& view) override {}    
     // Public methods to be called by Game class
-    void setOnPlatform(bool onPlatform, GameObject* platform = nullptr) { 
+    void setOnPlatform(bool onPlatform, EntityHandle platformHandle = EntityHandle()) { 
         m_onPlatform = onPlatform; 
+        GameObject* platform = World::getInstance().resolve(platformHandle);
         if(onPlatform && platform) {
-            m_attachedPlatform = platform;
+            m_attachedPlatform = platformHandle;
             auto platformBody = platform->get<BodyComponent>();
             if(platformBody) {
                 m_lastPlatformX = platformBody->x;
             }
         } else if (!onPlatform) {
-            m_attachedPlatform = nullptr;
+            m_attachedPlatform = EntityHandle();
         }
     }
     
+    // Standing on level geometry that carries nothing along, e.g. tiles
+    void setGrounded(bool grounded) { m_grounded = grounded; }
+    
     bool isGrounded() const { return m_grounded || m_onPlatform; }
     bool isDead() const { return m_isDead; }
     void die() { 
         m_isDead = true;
-        m_attachedPlatform = nullptr;
+        m_attachedPlatform = EntityHandle();
         respawn();
     }
     void respawn() { 
         m_isDead = false; 
-        m_attachedPlatform = nullptr;
+        m_attachedPlatform = EntityHandle();
         auto body = parent().get<BodyComponent>();
         if(body) {
-            body->x = 100;
-            body->y = 400;
+            // A teleport, not motion to sweep through
+            body->setPosition(100, 400);
             body->velocityX = 0;
             body->velocityY = 0;
         }
@@ -785,13 +3814,35 @@ private:
     bool m_grounded = false;
     bool m_onPlatform = false;
     bool m_isDead = false;
-    GameObject* m_attachedPlatform = nullptr;
+    EntityHandle m_attachedPlatform;
     float m_lastPlatformX = 0.0f;
 };
 
+// Advances a point bouncing between lo and hi by 'distance' along its path.
+// The path repeats every 2 * (hi - lo), so this is O(1) however long the gap.
+inline void advancePingPong(float& x, bool& movingRight, float lo, float hi, float distance) {
+    const float span = hi - lo;
+    if(span <= 0) return;
+    
+    const float period = 2 * span;
+    const float offset = std::clamp(x, lo, hi) - lo;
+    float phase = movingRight ? offset : period - offset;
+    phase = std::fmod(phase + distance, period);
+    
+    if(phase < span) {
+        x = lo + phase;
+        movingRight = true;
+    } else {
+        x = lo + (period - phase);
+        movingRight = false;
+    }
+}
+
 // Behavior Components
-class PatrolBehaviorComponent : public Component {
+class PatrolBehaviorComponent final : public Component {
 public:
+    static constexpr ComponentCaps kCaps = kCapsUpdate;
+    
     PatrolBehaviorComponent(float left, float right, float spd) : leftBound(left), rightBound(right), speed(spd) {}
     
     void update(float dt) override {
@@ -812,14 +3863,24 @@ public:
         body->velocityX = (body->x - body->prevX) / dt;
     }
     
-    void draw(SDL_Renderer* renderer, const View& view) override {}
-
+    // Jump ahead by 'elapsed' seconds spent dormant
+    void catchUp(float elapsed) {
+        auto body = parent().get<BodyComponent>();
+        if(!body) return;
+        
+        advancePingPong(body->x, movingRight, leftBound, rightBound - body->width, speed * elapsed);
+        body->prevX = body->x;
+        body->velocityX = 0;
+    }
+    
     float leftBound, rightBound, speed;
     bool movingRight = true;
 };
 
-class BounceBehaviorComponent : public Component {
+class BounceBehaviorComponent final : public Component {
 public:
+    static constexpr ComponentCaps kCaps = kCapsUpdate;
+    
     BounceBehaviorComponent(float amp, float freq) : amplitude(amp), frequency(freq) {}
     
     void update(float dt) override {
@@ -839,15 +3900,27 @@ public:
         body->velocityY = (body->y - body->prevY) / dt;
     }
     
-    void draw(SDL_Renderer* renderer, const View& view) override {}    
+    // Height is a pure function of time, so skipping ahead is exact
+    void catchUp(float elapsed) {
+        auto body = parent().get<BodyComponent>();
+        if(!body || baseY == 0) return;  // not started yet, update() seeds baseY
+        
+        time += elapsed;
+        body->y = baseY + amplitude * std::sin(frequency * time);
+        body->prevY = body->y;
+        body->velocityY = 0;
+    }
+    
     float amplitude, frequency;
     float baseY = 0;
     float time = 0;
 };
 
 // HorizontalMoveBehaviorComponent - Moves platform left and right
-class HorizontalMoveBehaviorComponent : public Component {
+class HorizontalMoveBehaviorComponent final : public Component {
 public:
+    static constexpr ComponentCaps kCaps = kCapsUpdate;
+    
     HorizontalMoveBehaviorComponent(float left, float right, float spd) 
         : leftBound(left), rightBound(right), speed(spd) {}
     
@@ -870,27 +3943,109 @@ public:
         body->velocityX = (body->x - body->prevX) / dt;
     }
     
-    void draw(SDL_Renderer* renderer, const View& view) override {}
-
+    // Jump ahead by 'elapsed' seconds spent dormant
+    void catchUp(float elapsed) {
+        auto body = parent().get<BodyComponent>();
+        if(!body) return;
+        
+        advancePingPong(body->x, movingRight, leftBound, rightBound - body->width, speed * elapsed);
+        body->prevX = body->x;
+        body->velocityX = 0;
+    }
+    
     float leftBound, rightBound, speed;
     bool movingRight = true;
 };
 
+// DormantComponent - Present while an entity is outside the activity region.
+// Its archetypes are skipped by every update pass; 'since' is the simulation
+// time it went dormant, used to catch its behaviors up when it wakes.
+class DormantComponent final : public Component {
+public:
+    static constexpr ComponentCaps kCaps = kCapsNone;
+    
+    explicit DormantComponent(float since = 0) : since(since) {}
+    
+    float since;
+};
+
+// SleepingComponent - Marks a settled physics body that is skipped by
+// integration and contact resolution until its island wakes (tag, no data)
+class SleepingComponent {
+public:
+    static constexpr ComponentCaps kCaps = kCapsNone;
+};
+
+// Touch every component pool before the World finishes constructing, so the
+// pools are destroyed after it at exit and its columns can still return chunks.
+inline World::World() {
+    TypeListVisitor<ComponentTypes>::visit([](auto* tag) {
+        using T = std::remove_pointer_t<decltype(tag)>;
+        if constexpr (!isTagComponent<T>()) {
+            ComponentPool<T>::getInstance();
+        }
+    });
+}
+
+// Mask of the component types whose kCaps include 'caps'
+template<typename List>
+struct ComponentCapsMask;
+
+template<typename... Ts>
+struct ComponentCapsMask<TypeList<Ts...>> {
+    static_assert(((!isTagComponent<Ts>() || Ts::kCaps == kCapsNone) && ...),
+                  "Tag components cannot have update or draw hooks");
+    
+    static constexpr ComponentMask with(ComponentCaps caps) {
+        return (ComponentMask(0) | ... | ((Ts::kCaps & caps) ? componentBit<Ts>() : ComponentMask(0)));
+    }
+};
+
+constexpr ComponentMask kUpdatableMask = ComponentCapsMask<ComponentTypes>::with(kCapsUpdate);
+constexpr ComponentMask kDrawableMask = ComponentCapsMask<ComponentTypes>::with(kCapsDraw);
+
+inline void GameObject::update(float dt) {
+    for(ComponentMask bits = m_mask & kUpdatableMask; bits; bits &= bits - 1) {
+        m_slots[lowestSetBit(bits)]->update(dt);
+    }
+}
+
+inline void GameObject::draw(SDL_Renderer* renderer, const View& view) {
+    for(ComponentMask bits = m_mask & kDrawableMask; bits; bits &= bits - 1) {
+        m_slots[lowestSetBit(bits)]->draw(renderer, view);
+    }
+}
+
 // ========================
 // XML Parser
 // ========================
 class XMLParser {
     public:
-        static std::vector<std::unique_ptr<GameObject>> parseXML(SDL_Renderer* renderer, const std::string& filename);
+        static std::vector<GameObject*> parseXML(SDL_Renderer* renderer, const std::string& filename);
         
         // Make this method public
         static std::string extractAttribute(const std::string& line, const std::string& attrName);
     
     private:
+        using AttributeMap = std::unordered_map<std::string, std::string>;
+        
         static SDL_Color parseColor(const std::string& colorStr);
-        static std::unique_ptr<GameObject> createGameObject(SDL_Renderer* renderer, const std::string& type, 
-                                                           const std::unordered_map<std::string, std::string>& attrs);
+        static float floatAttribute(const AttributeMap& attrs, const std::string& name, float fallback);
+        static GameObject* createGameObject(SDL_Renderer* renderer, const std::string& type, 
+                                            const AttributeMap& attrs);
+        // Adds the components for 'type' to a GameObject or a Prefab
+        template<typename Target>
+        static bool buildComponents(Target& target, const std::string& type, const AttributeMap& attrs);
+        static void createPrefab(const std::string& name, const std::string& type, const AttributeMap& attrs);
+        static std::vector<GameObject*> instantiatePrefab(const std::string& name, const AttributeMap& attrs);
+        static std::vector<GameObject*> instantiateBulk(const std::string& completeTag);
+        static RoleMask parseRoles(const std::string& type, const AttributeMap& attrs);
+        static void assignRoles(GameObject& obj, RoleMask roles);
+        template<typename Target>
+        static void assignCollisionLayer(Target& target, const AttributeMap& attrs);
+        static bool parseCollisionLayer(const std::string& name, CollisionLayer& layer);
         static std::string readCompleteTag(std::ifstream& file, std::string firstLine);
+        static void createTileLayer(const AttributeMap& attrs, const std::vector<std::string>& rows);
     };
     
     // Implementation of extractAttribute (outside the class)
@@ -938,8 +4093,8 @@ class XMLParser {
     }
     
     // Implementation of parseXML
-    std::vector<std::unique_ptr<GameObject>> XMLParser::parseXML(SDL_Renderer* renderer, const std::string& filename) {
-        std::vector<std::unique_ptr<GameObject>> gameObjects;
+    std::vector<GameObject*> XMLParser::parseXML(SDL_Renderer* renderer, const std::string& filename) {
+        std::vector<GameObject*> gameObjects;
         
         std::ifstream file(filename);
         if (!file.is_open()) {
@@ -949,8 +4104,13 @@ class XMLParser {
         
         std::string line;
         std::string currentObjectType;
+        std::string currentPrefab;
         std::unordered_map<std::string, std::string> currentAttributes;
         
+        // The <TileLayer> being read and its <Row> lines so far
+        AttributeMap tileLayerAttributes;
+        std::vector<std::string> tileRows;
+        
         while (std::getline(file, line)) {
             // Remove whitespace
             line.erase(0, line.find_first_not_of(" \t\r\n"));
@@ -962,8 +4122,44 @@ class XMLParser {
             if (line.find("<GameObject") != std::string::npos) {
                 std::string completeTag = readCompleteTag(file, line);
                 currentObjectType = extractAttribute(completeTag, "type");
+                currentPrefab = extractAttribute(completeTag, "prefab");
+                currentAttributes.clear();
+                currentAttributes["roles"] = extractAttribute(completeTag, "roles");
+                std::cout << "GameObject: " << (currentPrefab.empty() ? currentObjectType : "prefab " + currentPrefab) << std::endl;
+            }
+            else if (line.find("<Prefab") != std::string::npos) {
+                // Same body as a GameObject, built once and stored under 'name'
+                std::string completeTag = readCompleteTag(file, line);
+                currentObjectType = extractAttribute(completeTag, "type");
+                currentPrefab = extractAttribute(completeTag, "name");
+                currentAttributes.clear();
+                currentAttributes["roles"] = extractAttribute(completeTag, "roles");
+                std::cout << "Prefab: " << currentPrefab << " (" << currentObjectType << ")" << std::endl;
+            }
+            else if (line.find("</Prefab>") != std::string::npos) {
+                createPrefab(currentPrefab, currentObjectType, currentAttributes);
+                currentPrefab.clear();
                 currentAttributes.clear();
-                std::cout << "GameObject: " << currentObjectType << std::endl;
+            }
+            else if (line.find("<TileLayer") != std::string::npos) {
+                std::string completeTag = readCompleteTag(file, line);
+                tileLayerAttributes.clear();
+                tileRows.clear();
+                for (const char* name : { "x", "y", "tileSize", "textureKey", "tileX", "tileY", "tileWidth", "tileHeight" }) {
+                    tileLayerAttributes[name] = extractAttribute(completeTag, name);
+                }
+            }
+            else if (line.find("<Row") != std::string::npos) {
+                tileRows.push_back(extractAttribute(line, "cells"));
+            }
+            else if (line.find("</TileLayer>") != std::string::npos) {
+                createTileLayer(tileLayerAttributes, tileRows);
+                tileRows.clear();
+            }
+            else if (line.find("<Instantiate") != std::string::npos) {
+                std::string completeTag = readCompleteTag(file, line);
+                auto spawned = instantiateBulk(completeTag);
+                gameObjects.insert(gameObjects.end(), spawned.begin(), spawned.end());
             }
             else if (line.find("<BodyComponent") != std::string::npos) {
                 std::string completeTag = readCompleteTag(file, line);
@@ -971,6 +4167,8 @@ class XMLParser {
                 currentAttributes["y"] = extractAttribute(completeTag, "y");
                 currentAttributes["width"] = extractAttribute(completeTag, "width");
                 currentAttributes["height"] = extractAttribute(completeTag, "height");
+                currentAttributes["layer"] = extractAttribute(completeTag, "layer");
+                currentAttributes["collidesWith"] = extractAttribute(completeTag, "collidesWith");
                 std::cout << "BodyComponent: " << currentAttributes["x"] << "," << currentAttributes["y"] 
                           << " " << currentAttributes["width"] << "x" << currentAttributes["height"] << std::endl;
             }
@@ -992,10 +4190,17 @@ class XMLParser {
                 currentAttributes["speed"] = extractAttribute(completeTag, "speed");
             }
             else if (line.find("</GameObject>") != std::string::npos) {
-                // Create the GameObject with all collected attributes
-                auto obj = createGameObject(renderer, currentObjectType, currentAttributes);
-                if (obj) {
-                    gameObjects.push_back(std::move(obj));
+                if (!currentPrefab.empty()) {
+                    // Copy of a prefab; the attributes given here override its values
+                    auto spawned = instantiatePrefab(currentPrefab, currentAttributes);
+                    gameObjects.insert(gameObjects.end(), spawned.begin(), spawned.end());
+                    currentPrefab.clear();
+                } else {
+                    // Create the GameObject with all collected attributes
+                    GameObject* obj = createGameObject(renderer, currentObjectType, currentAttributes);
+                    if (obj) {
+                        gameObjects.push_back(obj);
+                    }
                 }
                 currentAttributes.clear();
                 std::cout << "--- Finished GameObject ---" << std::endl;
@@ -1057,22 +4262,134 @@ class XMLParser {
         return color;
     }
     
+    // Empty or missing attributes fall back, so prefabs may leave out values
+    // such as position that every instance sets
+    float XMLParser::floatAttribute(const AttributeMap& attrs, const std::string& name, float fallback) {
+        auto it = attrs.find(name);
+        if (it == attrs.end() || it->second.empty()) return fallback;
+        return std::stof(it->second);
+    }
+    
+    // One grid of tiles, e.g.
+    //   <TileLayer x="0" y="520" tileSize="16" textureKey="tile_texture" tileX="4" tileY="3">
+    //     <Row cells="####....####" />
+    //   </TileLayer>
+    // with a Row per line of cells, top to bottom; '.' is an empty cell
+    void XMLParser::createTileLayer(const AttributeMap& attrs, const std::vector<std::string>& rows) {
+        auto& tiles = TileCollisionLayer::getInstance();
+        tiles.load(floatAttribute(attrs, "x", 0), floatAttribute(attrs, "y", 0), floatAttribute(attrs, "tileSize", 16), rows);
+        
+        auto textureKey = attrs.find("textureKey");
+        tiles.setAppearance(textureKey != attrs.end() ? textureKey->second : "",
+                            static_cast<int>(floatAttribute(attrs, "tileX", 0)),
+                            static_cast<int>(floatAttribute(attrs, "tileY", 0)),
+                            static_cast<int>(floatAttribute(attrs, "tileWidth", 16)),
+                            static_cast<int>(floatAttribute(attrs, "tileHeight", 16)));
+    }
+    
     // Implementation of createGameObject
-    std::unique_ptr<GameObject> XMLParser::createGameObject(SDL_Renderer* renderer, const std::string& type, 
-                                                           const std::unordered_map<std::string, std::string>& attrs) {
+    // Entities are created directly in the World; add<T>() places each component in its archetype
+    GameObject* XMLParser::createGameObject(SDL_Renderer* renderer, const std::string& type, 
+                                            const AttributeMap& attrs) {
+        GameObject* obj = World::getInstance().createEntity();
+        if (!buildComponents(*obj, type, attrs)) {
+            World::getInstance().destroyEntity(obj);
+            return nullptr;
+        }
+        assignRoles(*obj, parseRoles(type, attrs));
+        assignCollisionLayer(*obj, attrs);
+        return obj;
+    }
+    
+    bool XMLParser::parseCollisionLayer(const std::string& name, CollisionLayer& layer) {
+        auto found = std::find_if(std::begin(kCollisionLayerNames), std::end(kCollisionLayerNames),
+                                  [&name](const char* layerName) { return name == layerName; });
+        if (found == std::end(kCollisionLayerNames)) {
+            std::cerr << "WARNING: Unknown collision layer: " << name << std::endl;
+            return false;
+        }
+        layer = static_cast<CollisionLayer>(found - std::begin(kCollisionLayerNames));
+        return true;
+    }
+    
+    // layer="enemy" collidesWith="player,solid" on a BodyComponent, overriding
+    // the defaults from applyDefaultCollisionLayer. Those are filled in first
+    // so an override of only one of the two keeps the default for the other.
+    // Prefab instances keep their prefab's layer unless they override it.
+    template<typename Target>
+    void XMLParser::assignCollisionLayer(Target& target, const AttributeMap& attrs) {
+        BodyComponent* body = target.template get<BodyComponent>();
+        if (!body) return;
+        applyDefaultCollisionLayer(target.mask(), *body);
+        
+        auto it = attrs.find("layer");
+        if (it != attrs.end() && !it->second.empty()) {
+            parseCollisionLayer(it->second, body->layer);
+        }
+        
+        it = attrs.find("collidesWith");
+        if (it == attrs.end() || it->second.empty()) return;
+        
+        body->collidesWith = 0;
+        std::stringstream ss(it->second);
+        std::string name;
+        while (std::getline(ss, name, ',')) {
+            name.erase(0, name.find_first_not_of(" \t"));
+            name.erase(name.find_last_not_of(" \t") + 1);
+            
+            CollisionLayer layer;
+            if (parseCollisionLayer(name, layer)) body->collidesWith |= layerBit(layer);
+        }
+    }
+    
+    // roles="player,camera_target" on a GameObject or Prefab; players get both by default
+    RoleMask XMLParser::parseRoles(const std::string& type, const AttributeMap& attrs) {
+        RoleMask roles = 0;
+        if (type == "player") {
+            roles |= roleBit(EntityRole::Player) | roleBit(EntityRole::CameraTarget);
+        }
+        
+        auto it = attrs.find("roles");
+        if (it == attrs.end() || it->second.empty()) return roles;
+        
+        std::stringstream ss(it->second);
+        std::string name;
+        while (std::getline(ss, name, ',')) {
+            name.erase(0, name.find_first_not_of(" \t"));
+            name.erase(name.find_last_not_of(" \t") + 1);
+            
+            auto found = std::find_if(std::begin(kEntityRoleNames), std::end(kEntityRoleNames),
+                                      [&name](const char* roleName) { return name == roleName; });
+            if (found == std::end(kEntityRoleNames)) {
+                std::cerr << "WARNING: Unknown role: " << name << std::endl;
+                continue;
+            }
+            roles |= roleBit(static_cast<EntityRole>(found - std::begin(kEntityRoleNames)));
+        }
+        return roles;
+    }
+    
+    void XMLParser::assignRoles(GameObject& obj, RoleMask roles) {
+        auto& world = World::getInstance();
+        for (std::size_t role = 0; role < kEntityRoleCount; ++role) {
+            if (roles & roleBit(static_cast<EntityRole>(role))) world.assignRole(obj, static_cast<EntityRole>(role));
+        }
+    }
+    
+    template<typename Target>
+    bool XMLParser::buildComponents(Target& target, const std::string& type, const AttributeMap& attrs) {
         auto& textureManager = TextureManager::getInstance();
-        auto obj = std::make_unique<GameObject>();
         
         if (type == "player") {
             // Player
-            float x = std::stof(attrs.at("x"));
-            float y = std::stof(attrs.at("y"));
-            float width = std::stof(attrs.at("width"));
-            float height = std::stof(attrs.at("height"));
+            float x = floatAttribute(attrs, "x", 0.0f);
+            float y = floatAttribute(attrs, "y", 0.0f);
+            float width = floatAttribute(attrs, "width", 0.0f);
+            float height = floatAttribute(attrs, "height", 0.0f);
             
-            obj->add<BodyComponent>(x, y, width, height);
+            target.template add<BodyComponent>(x, y, width, height);
             
-            auto sprite = obj->add<SpriteComponent>(attrs.at("textureKey"));
+            auto sprite = target.template add<SpriteComponent>(attrs.at("textureKey"));
             SDL_Texture* texture = textureManager.getTexture(attrs.at("textureKey"));
             if (texture) {
                 sprite->setTexture(texture);
@@ -1092,21 +4409,21 @@ class XMLParser {
                 sprite->setSpriteSheet(frameWidth, frameHeight, totalFrames, frameRate);
             }
             
-            obj->add<ControllerComponent>();
+            target.template add<ControllerComponent>();
         }
         else if (type == "platform" || type == "moving_platform") {
             // Platform
-            float x = std::stof(attrs.at("x"));
-            float y = std::stof(attrs.at("y"));
-            float width = std::stof(attrs.at("width"));
-            float height = std::stof(attrs.at("height"));
+            float x = floatAttribute(attrs, "x", 0.0f);
+            float y = floatAttribute(attrs, "y", 0.0f);
+            float width = floatAttribute(attrs, "width", 0.0f);
+            float height = floatAttribute(attrs, "height", 0.0f);
             
-            obj->add<BodyComponent>(x, y, width, height);
-            obj->add<SolidComponent>();
+            target.template add<BodyComponent>(x, y, width, height);
+            target.template add<SolidComponent>();
             
             // Handle sprite with texture or color
             if (attrs.find("textureKey") != attrs.end() && !attrs.at("textureKey").empty()) {
-                auto sprite = obj->add<SpriteComponent>(attrs.at("textureKey"));
+                auto sprite = target.template add<SpriteComponent>(attrs.at("textureKey"));
                 SDL_Texture* texture = textureManager.getTexture(attrs.at("textureKey"));
                 if (texture) {
                     sprite->setTexture(texture);
@@ -1127,7 +4444,7 @@ class XMLParser {
                 }
             } else if (attrs.find("color") != attrs.end()) {
                 SDL_Color color = parseColor(attrs.at("color"));
-                obj->add<SpriteComponent>("", color);
+                target.template add<SpriteComponent>("", color);
             }
             
             // Moving platform behavior
@@ -1135,20 +4452,20 @@ class XMLParser {
                 float left = std::stof(attrs.at("left"));
                 float right = std::stof(attrs.at("right"));
                 float speed = std::stof(attrs.at("speed"));
-                obj->add<HorizontalMoveBehaviorComponent>(left, right, speed);
+                target.template add<HorizontalMoveBehaviorComponent>(left, right, speed);
             }
         }
         else if (type == "enemy" || type == "flying_enemy") {
             // Enemy
-            float x = std::stof(attrs.at("x"));
-            float y = std::stof(attrs.at("y"));
-            float width = std::stof(attrs.at("width"));
-            float height = std::stof(attrs.at("height"));
+            float x = floatAttribute(attrs, "x", 0.0f);
+            float y = floatAttribute(attrs, "y", 0.0f);
+            float width = floatAttribute(attrs, "width", 0.0f);
+            float height = floatAttribute(attrs, "height", 0.0f);
             
-            obj->add<BodyComponent>(x, y, width, height);
-            obj->add<EnemyComponent>();
+            target.template add<BodyComponent>(x, y, width, height);
+            target.template add<EnemyComponent>();
             
-            auto sprite = obj->add<SpriteComponent>(attrs.at("textureKey"));
+            auto sprite = target.template add<SpriteComponent>(attrs.at("textureKey"));
             SDL_Texture* texture = textureManager.getTexture(attrs.at("textureKey"));
             if (texture) {
                 sprite->setTexture(texture);
@@ -1173,11 +4490,11 @@ class XMLParser {
                 float left = std::stof(attrs.at("left"));
                 float right = std::stof(attrs.at("right"));
                 float speed = std::stof(attrs.at("speed"));
-                obj->add<PatrolBehaviorComponent>(left, right, speed);
+                target.template add<PatrolBehaviorComponent>(left, right, speed);
             } else if (type == "flying_enemy") {
                 float amplitude = std::stof(attrs.at("amplitude"));
                 float frequency = std::stof(attrs.at("frequency"));
-                obj->add<BounceBehaviorComponent>(amplitude, frequency);
+                target.template add<BounceBehaviorComponent>(amplitude, frequency);
             }
         }
         else if (type == "tiling_background") {
@@ -1187,7 +4504,7 @@ class XMLParser {
                 textureKey = attrs.at("textureKey");
             } else {
                 std::cerr << "ERROR: tiling_background missing required textureKey attribute" << std::endl;
-                return nullptr;
+                return false;
             }
             
             float scrollSpeedX = 0.0f;
@@ -1199,60 +4516,615 @@ class XMLParser {
             if (attrs.find("scrollSpeedY") != attrs.end()) {
                 scrollSpeedY = std::stof(attrs.at("scrollSpeedY"));
             }
-            
-            std::cout << "Creating tiling background with texture: " << textureKey 
-                      << " scroll: (" << scrollSpeedX << "," << scrollSpeedY << ")" << std::endl;
-            
-            obj->add<TilingBackgroundComponent>(textureKey, scrollSpeedX, scrollSpeedY);
+            
+            std::cout << "Creating tiling background with texture: " << textureKey 
+                      << " scroll: (" << scrollSpeedX << "," << scrollSpeedY << ")" << std::endl;
+            
+            target.template add<TilingBackgroundComponent>(textureKey, scrollSpeedX, scrollSpeedY);
+        }
+        return true;
+    }
+    
+    // Builds a prefab through the same path as a GameObject, so the sprite
+    // sheet setup and attribute parsing happen once for all its instances
+    void XMLParser::createPrefab(const std::string& name, const std::string& type, const AttributeMap& attrs) {
+        if (name.empty()) {
+            std::cerr << "ERROR: Prefab is missing its name attribute" << std::endl;
+            return;
+        }
+        
+        auto prefab = std::make_unique<Prefab>();
+        if (!buildComponents(*prefab, type, attrs)) {
+            std::cerr << "ERROR: Failed to build prefab: " << name << std::endl;
+            return;
+        }
+        assignCollisionLayer(*prefab, attrs);
+        prefab->setRoles(parseRoles(type, attrs));
+        World::getInstance().registerPrefab(name, std::move(prefab));
+        std::cout << "--- Registered Prefab " << name << " ---" << std::endl;
+    }
+    
+    // One instance; only the attributes present in the GameObject are applied,
+    // and its roles add to those of the prefab
+    std::vector<GameObject*> XMLParser::instantiatePrefab(const std::string& name, const AttributeMap& attrs) {
+        Prefab* prefab = World::getInstance().findPrefab(name);
+        if (!prefab) {
+            std::cerr << "ERROR: Unknown prefab: " << name << std::endl;
+            return {};
+        }
+        
+        auto has = [&attrs](const char* key) {
+            auto it = attrs.find(key);
+            return it != attrs.end() && !it->second.empty();
+        };
+        
+        return World::getInstance().instantiate(*prefab, 1, [&](std::size_t, GameObject& obj) {
+            assignRoles(obj, parseRoles("", attrs));
+            assignCollisionLayer(obj, attrs);
+            if (auto body = obj.get<BodyComponent>()) {
+                body->setPosition(floatAttribute(attrs, "x", body->x), floatAttribute(attrs, "y", body->y));
+                body->width = floatAttribute(attrs, "width", body->width);
+                body->height = floatAttribute(attrs, "height", body->height);
+            }
+            if (auto bounce = obj.get<BounceBehaviorComponent>()) {
+                bounce->amplitude = floatAttribute(attrs, "amplitude", bounce->amplitude);
+                bounce->frequency = floatAttribute(attrs, "frequency", bounce->frequency);
+            }
+            if (has("left") || has("right") || has("speed")) {
+                if (auto patrol = obj.get<PatrolBehaviorComponent>()) {
+                    patrol->leftBound = floatAttribute(attrs, "left", patrol->leftBound);
+                    patrol->rightBound = floatAttribute(attrs, "right", patrol->rightBound);
+                    patrol->speed = floatAttribute(attrs, "speed", patrol->speed);
+                }
+                if (auto move = obj.get<HorizontalMoveBehaviorComponent>()) {
+                    move->leftBound = floatAttribute(attrs, "left", move->leftBound);
+                    move->rightBound = floatAttribute(attrs, "right", move->rightBound);
+                    move->speed = floatAttribute(attrs, "speed", move->speed);
+                }
+            }
+        });
+    }
+    
+    // <Instantiate prefab="name" count="N" x="" y="" stepX="" stepY="" />
+    // places N copies in a row starting at (x, y), defaulting to the prefab's position
+    std::vector<GameObject*> XMLParser::instantiateBulk(const std::string& completeTag) {
+        const std::string name = extractAttribute(completeTag, "prefab");
+        Prefab* prefab = World::getInstance().findPrefab(name);
+        if (!prefab) {
+            std::cerr << "ERROR: Unknown prefab: " << name << std::endl;
+            return {};
+        }
+        
+        AttributeMap attrs;
+        for (const char* key : {"count", "x", "y", "stepX", "stepY"}) {
+            attrs[key] = extractAttribute(completeTag, key);
+        }
+        const int count = static_cast<int>(floatAttribute(attrs, "count", 1.0f));
+        if (count <= 0) return {};
+        
+        BodyComponent* protoBody = prefab->get<BodyComponent>();
+        const float startX = floatAttribute(attrs, "x", protoBody ? protoBody->x : 0.0f);
+        const float startY = floatAttribute(attrs, "y", protoBody ? protoBody->y : 0.0f);
+        const float stepX = floatAttribute(attrs, "stepX", 0.0f);
+        const float stepY = floatAttribute(attrs, "stepY", 0.0f);
+        
+        std::cout << "Instantiating " << count << " x " << name << std::endl;
+        return World::getInstance().instantiate(*prefab, static_cast<std::size_t>(count), [&](std::size_t i, GameObject& obj) {
+            if (auto body = obj.get<BodyComponent>()) {
+                body->setPosition(startX + stepX * i, startY + stepY * i);
+            }
+        });
+    }
+// ========================
+// XML Component Factory
+// ========================
+class XMLComponentFactory {
+public:
+    static std::vector<GameObject*> createFromXML(SDL_Renderer* renderer, const std::string& filename) {
+        std::vector<GameObject*> gameObjects;
+        
+        std::cout << "Loading game objects from: " << filename << std::endl;
+        
+        // Load textures first from the XML
+        loadTexturesFromXML(renderer, filename);
+        
+        // Parse the XML file to create game objects; a level without tiles leaves none behind
+        TileCollisionLayer::getInstance().clear();
+        gameObjects = XMLParser::parseXML(renderer, filename);
+        
+        // Level geometry is final now; bake it once
+        StaticBvh::getInstance().build(World::getInstance());
+        
+        return gameObjects;
+    }
+    
+private:
+    static void loadTexturesFromXML(SDL_Renderer* renderer, const std::string& filename) {
+        auto& textureManager = TextureManager::getInstance();
+        
+        std::ifstream file(filename);
+        if (!file.is_open()) {
+            std::cerr << "ERROR: Failed to open XML file: " << filename << std::endl;
+            return;
+        }
+        
+        std::cout << "=== Loading Textures from XML ===" << std::endl;
+        std::string line;
+        while (std::getline(file, line)) {
+            if (line.find("<Texture") != std::string::npos) {
+                std::string filePath = XMLParser::extractAttribute(line, "file");
+                std::string textureKey = XMLParser::extractAttribute(line, "key");
+                
+                if (!filePath.empty() && !textureKey.empty()) {
+                    std::cout << "Found texture definition: " << textureKey << " -> " << filePath << std::endl;
+                    textureManager.loadTexture(renderer, filePath, textureKey);
+                }
+            }
+        }
+        
+        file.close();
+        std::cout << "=== Finished Loading Textures ===" << std::endl;
+    }
+};
+
+// ========================
+// Worker Pool
+// ========================
+class WorkerPool {
+public:
+    explicit WorkerPool(std::size_t threadCount) {
+        for(std::size_t i = 0; i < threadCount; ++i) {
+            m_threads.emplace_back([this] { workerLoop(); });
+        }
+    }
+    
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for(auto& thread : m_threads) {
+            thread.join();
+        }
+    }
+    
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+    
+    std::size_t threadCount() const { return m_threads.size(); }
+    
+    // Runs job(i) for every i in [0, count) on the workers and the calling
+    // thread, and returns once all of them have finished. A call made from
+    // inside a job (a system splitting its own work) runs inline.
+    void parallelFor(std::size_t count, const std::function<void(std::size_t)>& job) {
+        if(m_threads.empty() || count <= 1 || t_insideJob) {
+            for(std::size_t i = 0; i < count; ++i) job(i);
+            return;
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_job = &job;
+            m_jobCount = count;
+            m_nextJob = 0;
+            m_busyWorkers = m_threads.size();
+            m_generation++;
+        }
+        m_wake.notify_all();
+        
+        runJobs();
+        
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this] { return m_busyWorkers == 0; });
+        m_job = nullptr;
+    }
+    
+private:
+    void workerLoop() {
+        std::uint64_t seenGeneration = 0;
+        for(;;) {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [&] { return m_stop || m_generation != seenGeneration; });
+                if(m_stop) return;
+                seenGeneration = m_generation;
+            }
+            
+            runJobs();
+            
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if(--m_busyWorkers == 0) {
+                m_done.notify_one();
+            }
+        }
+    }
+    
+    void runJobs() {
+        t_insideJob = true;
+        for(;;) {
+            std::size_t index = m_nextJob.fetch_add(1);
+            if(index >= m_jobCount) break;
+            (*m_job)(index);
+        }
+        t_insideJob = false;
+    }
+    
+    static inline thread_local bool t_insideJob = false;
+    
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    const std::function<void(std::size_t)>* m_job = nullptr;
+    std::size_t m_jobCount = 0;
+    std::atomic<std::size_t> m_nextJob{0};
+    std::size_t m_busyWorkers = 0;
+    std::uint64_t m_generation = 0;
+    bool m_stop = false;
+};
+
+// ========================
+// System Scheduler
+// ========================
+// Systems declare which component types (and shared resources) they read
+// and write. Each system is placed in the first stage after every earlier
+// system it conflicts with; systems sharing a stage run concurrently on
+// the worker pool, while declaration order is kept between conflicting ones.
+using AccessMask = std::uint64_t;
+
+constexpr AccessMask kViewResource = AccessMask(1) << 32;   // Engine's main View
+constexpr AccessMask kInputResource = AccessMask(1) << 33;  // InputSystem key state
+
+template<typename... Ts>
+constexpr AccessMask componentAccess() {
+    return (AccessMask(0) | ... | AccessMask(componentBit<Ts>()));
+}
+
+class SystemScheduler {
+public:
+    explicit SystemScheduler(WorkerPool& workers) : m_workers(workers) {}
+    
+    void addSystem(const std::string& name, AccessMask reads, AccessMask writes, std::function<void(float)> run) {
+        SystemEntry entry;
+        entry.name = name;
+        entry.reads = reads | writes;
+        entry.writes = writes;
+        entry.run = std::move(run);
+        
+        for(const auto& other : m_systems) {
+            bool conflicts = (entry.writes & other.reads) || (other.writes & entry.reads);
+            if(conflicts) {
+                entry.stage = std::max(entry.stage, other.stage + 1);
+            }
         }
-        return obj;
+        
+        if(entry.stage >= m_stages.size()) {
+            m_stages.resize(entry.stage + 1);
+        }
+        m_stages[entry.stage].push_back(m_systems.size());
+        m_systems.push_back(std::move(entry));
+    }
+    
+    void run(float dt) {
+        for(const auto& stage : m_stages) {
+            m_workers.parallelFor(stage.size(), [this, &stage, dt](std::size_t i) {
+                SystemEntry& system = m_systems[stage[i]];
+                auto start = std::chrono::steady_clock::now();
+                system.run(dt);
+                std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+                system.lastFrameMs = elapsed.count();
+                system.totalMs += elapsed.count();
+            });
+        }
+        m_framesTimed++;
+    }
+    
+    // Prints each system's stage and average cost since the last call
+    void logTimings() {
+        if(m_framesTimed == 0) return;
+        std::cout << "System timings (avg over " << m_framesTimed << " frames, "
+                  << m_workers.threadCount() << " workers):" << std::endl;
+        for(auto& system : m_systems) {
+            std::cout << "  [stage " << system.stage << "] " << system.name << ": "
+                      << (system.totalMs / m_framesTimed) << " ms" << std::endl;
+            system.totalMs = 0.0;
+        }
+        m_framesTimed = 0;
     }
+    
+    double lastFrameMs(const std::string& name) const {
+        for(const auto& system : m_systems) {
+            if(system.name == name) return system.lastFrameMs;
+        }
+        return 0.0;
+    }
+    
+private:
+    struct SystemEntry {
+        std::string name;
+        AccessMask reads = 0;
+        AccessMask writes = 0;
+        std::function<void(float)> run;
+        std::size_t stage = 0;
+        double lastFrameMs = 0.0;
+        double totalMs = 0.0;
+    };
+    
+    WorkerPool& m_workers;
+    std::vector<SystemEntry> m_systems;
+    std::vector<std::vector<std::size_t>> m_stages;
+    int m_framesTimed = 0;
+};
+
 // ========================
-// XML Component Factory
+// Simulation LOD
 // ========================
-class XMLComponentFactory {
+// Entities far from the main view go dormant and stop updating, so frame
+// cost follows what is near the player rather than the size of the level.
+// The region is re-evaluated a few times a second; waking is done at a
+// smaller radius than sleeping so entities on the edge do not flicker.
+// Dormant entities still collide, they are just frozen in place.
+class SimulationLOD {
 public:
-    static std::vector<std::unique_ptr<GameObject>> createFromXML(SDL_Renderer* renderer, const std::string& filename) {
-        std::vector<std::unique_ptr<GameObject>> gameObjects;
+    void setActivityRadius(float radius) { m_radius = radius; }
+    float activityRadius() const { return m_radius; }
+    
+    void setHysteresis(float margin) { m_hysteresis = margin; }
+    void setCheckInterval(float seconds) { m_checkInterval = seconds; }
+    
+    std::size_t dormantCount() const { return m_dormantCount; }
+    
+    // Sleeps and wakes go through the command buffer and land at the end of
+    // the frame. Catch-up is applied here, while the entity is still dormant,
+    // so it is never both caught up and updated for the same frame.
+    void update(float dt, World& world, const View& view) {
+        m_clock += dt;
+        m_sinceCheck += dt;
+        if(m_sinceCheck < m_checkInterval) return;
+        m_sinceCheck = 0;
         
-        std::cout << "Loading game objects from: " << filename << std::endl;
+        const float cx = view.centerX();
+        const float cy = view.centerY();
+        const float sleepRadius = m_radius + m_hysteresis;
+        CommandBuffer& commands = world.commands();
         
-        // Load textures first from the XML
-        loadTexturesFromXML(renderer, filename);
+        // Players and backgrounds are always live; level geometry never
+        // updates, so there is nothing to put to sleep
+        world.view<BodyComponent>()
+            .without<ControllerComponent, TilingBackgroundComponent, DormantComponent>()
+            .each([&](GameObject& obj, BodyComponent& body) {
+                if(isStaticBody(obj.mask())) return;
+                if(distanceSquared(body, cx, cy) > sleepRadius * sleepRadius) {
+                    commands.addComponent<DormantComponent>(obj.handle(), m_clock);
+                }
+            });
         
-        // Parse the XML file to create game objects
-        gameObjects = XMLParser::parseXML(renderer, filename);
+        m_dormantCount = 0;
+        world.view<BodyComponent, DormantComponent>().each([&](GameObject& obj, BodyComponent& body, DormantComponent& dormant) {
+            if(distanceSquared(body, cx, cy) > m_radius * m_radius) {
+                m_dormantCount++;
+                return;
+            }
+            wake(obj, body, m_clock - dormant.since);
+            commands.removeComponent<DormantComponent>(obj.handle());
+        });
+    }
+    
+private:
+    // From (cx, cy) to the nearest point of the body's bounds
+    static float distanceSquared(const BodyComponent& body, float cx, float cy) {
+        const float dx = std::max({ body.x - cx, 0.0f, cx - (body.x + body.width) });
+        const float dy = std::max({ body.y - cy, 0.0f, cy - (body.y + body.height) });
+        return dx * dx + dy * dy;
+    }
+    
+    static void wake(GameObject& obj, BodyComponent& body, float elapsed) {
+        if(auto patrol = obj.get<PatrolBehaviorComponent>()) patrol->catchUp(elapsed);
+        if(auto move = obj.get<HorizontalMoveBehaviorComponent>()) move->catchUp(elapsed);
+        if(auto bounce = obj.get<BounceBehaviorComponent>()) bounce->catchUp(elapsed);
         
-        return gameObjects;
+        // No velocity spike from the jump
+        body.prevX = body.x;
+        body.prevY = body.y;
+    }
+    
+    float m_radius = 1200.0f;
+    float m_hysteresis = 200.0f;
+    float m_checkInterval = 0.25f;
+    float m_sinceCheck = 0.25f;  // evaluate on the first frame
+    float m_clock = 0;
+    std::size_t m_dormantCount = 0;
+};
+
+// ========================
+// Sleep Islands
+// ========================
+// Physics bodies that have sat still with the same contacts for
+// kStillFramesToSleep frames fall asleep: integration skips them and they
+// stop resolving their own contacts, though awake bodies still collide with
+// them. Bodies in contact sleep and wake together as one island; level
+// geometry never joins an island. A sleeping island wakes when something
+// awake that it pairs with in the broadphase moves, when one of its contacts
+// goes away, or when a member is given a velocity or passed to wake().
+class SleepIslands {
+public:
+    static constexpr int kStillFramesToSleep = 30;
+    
+    std::size_t sleepingCount() const { return m_islandOf.size(); }
+    
+    // Run once contacts are resolved, with that frame's broadphase and events.
+    // Sleeps and wakes go through the command buffer and land at the end of the frame.
+    void update(World& world, const Broadphase& broadphase, const ContactEventBuffer& events) {
+        wakeDisturbed(world, broadphase, events);
+        sleepSettled(world, events);
+    }
+    
+    // Wakes the island 'handle' is asleep in, if any, e.g. for scripted input
+    void wake(World& world, EntityHandle handle) {
+        auto found = m_islandOf.find(handle.value);
+        if(found == m_islandOf.end()) return;
+        
+        const std::uint32_t island = found->second;
+        for(EntityHandle member : m_islands[island]) {
+            m_islandOf.erase(member.value);
+            if(GameObject* obj = world.resolve(member)) {
+                world.commands().removeComponent<SleepingComponent>(member);
+                if(auto physics = obj->get<PhysicsComponent>()) physics->restingFrames = 0;
+            }
+        }
+        m_islands[island].clear();
+        m_freeIslands.push_back(island);
     }
     
 private:
-    static void loadTexturesFromXML(SDL_Renderer* renderer, const std::string& filename) {
-        auto& textureManager = TextureManager::getInstance();
+    static bool moved(const BodyComponent& body) {
+        return body.getVelocityX() != 0 || body.getVelocityY() != 0;
+    }
+    
+    // Forgets sleeping bodies that were destroyed, as nothing wakes them
+    void pruneDestroyed(World& world) {
+        if(m_version == world.structureVersion()) return;
+        m_version = world.structureVersion();
         
-        std::ifstream file(filename);
-        if (!file.is_open()) {
-            std::cerr << "ERROR: Failed to open XML file: " << filename << std::endl;
-            return;
+        for(auto it = m_islandOf.begin(); it != m_islandOf.end();) {
+            EntityHandle handle;
+            handle.value = it->first;
+            if(world.resolve(handle)) {
+                ++it;
+                continue;
+            }
+            auto& members = m_islands[it->second];
+            members.erase(std::find(members.begin(), members.end(), handle));
+            if(members.empty()) m_freeIslands.push_back(it->second);
+            it = m_islandOf.erase(it);
+        }
+    }
+    
+    void wakeDisturbed(World& world, const Broadphase& broadphase, const ContactEventBuffer& events) {
+        pruneDestroyed(world);
+        for(std::uint32_t i = 0; i < broadphase.proxyCount(); ++i) {
+            const BroadphaseProxy& proxy = broadphase.proxy(i);
+            if(!proxy.object->has<SleepingComponent>()) continue;
+            
+            bool disturbed = proxy.body->velocityX != 0 || proxy.body->velocityY != 0;
+            for(std::uint32_t partner : broadphase.partners(i)) {
+                const BroadphaseProxy& other = broadphase.proxy(partner);
+                if(!other.object->has<SleepingComponent>() && moved(*other.body)) disturbed = true;
+            }
+            if(disturbed) wake(world, proxy.handle);
         }
         
-        std::cout << "=== Loading Textures from XML ===" << std::endl;
-        std::string line;
-        while (std::getline(file, line)) {
-            if (line.find("<Texture") != std::string::npos) {
-                std::string filePath = XMLParser::extractAttribute(line, "file");
-                std::string textureKey = XMLParser::extractAttribute(line, "key");
-                
-                if (!filePath.empty() && !textureKey.empty()) {
-                    std::cout << "Found texture definition: " << textureKey << " -> " << filePath << std::endl;
-                    textureManager.loadTexture(renderer, filePath, textureKey);
-                }
+        // A sleeping body's contacts are only dropped once the other body is gone
+        events.forEach([&](const ContactEvent& event) {
+            if(event.phase == ContactPhase::Exit) wake(world, event.self);
+        });
+    }
+    
+    void sleepSettled(World& world, const ContactEventBuffer& events) {
+        m_candidates.clear();
+        m_candidateIndex.clear();
+        world.view<BodyComponent, PhysicsComponent>()
+            .without<ControllerComponent, PatrolBehaviorComponent, BounceBehaviorComponent,
+                     HorizontalMoveBehaviorComponent, DormantComponent, SleepingComponent>()
+            .each([this](GameObject& obj, BodyComponent& body, PhysicsComponent& physics) {
+                const bool still = !moved(body) && body.velocityX == 0 && body.velocityY == 0;
+                physics.restingFrames = still ? physics.restingFrames + 1 : 0;
+                m_candidateIndex[obj.handle().value] = static_cast<std::uint32_t>(m_candidates.size());
+                m_candidates.push_back({ obj.handle(), &physics });
+            });
+        if(m_candidates.empty()) return;
+        
+        m_parent.resize(m_candidates.size());
+        for(std::uint32_t i = 0; i < m_parent.size(); ++i) m_parent[i] = i;
+        m_pinned.assign(m_candidates.size(), false);
+        
+        // Link bodies in contact. Touching something else that moved this
+        // frame pins the island awake; a contact starting or ending restarts
+        // the count. Bodies that stay put, e.g. a stopped platform, are ground.
+        events.forEach([&](const ContactEvent& event) {
+            const std::uint32_t self = candidateIndex(event.self);
+            const std::uint32_t other = candidateIndex(event.other);
+            if(self == kNone && other == kNone) return;
+            
+            if(event.phase != ContactPhase::Stay) {
+                if(self != kNone) m_candidates[self].physics->restingFrames = 0;
+                if(other != kNone) m_candidates[other].physics->restingFrames = 0;
+            }
+            if(event.phase == ContactPhase::Exit) return;
+            
+            if(self != kNone && other != kNone) {
+                m_parent[find(self)] = find(other);
+                return;
+            }
+            GameObject* outside = world.resolve(self == kNone ? event.self : event.other);
+            if(outside && outside->has<BodyComponent>() && moved(*outside->get<BodyComponent>())) {
+                m_pinned[self != kNone ? self : other] = true;
             }
+        });
+        
+        // An island sleeps once every member is ready and none is pinned
+        m_ready.assign(m_candidates.size(), true);
+        for(std::uint32_t i = 0; i < m_candidates.size(); ++i) {
+            if(m_pinned[i] || m_candidates[i].physics->restingFrames < kStillFramesToSleep) m_ready[find(i)] = false;
         }
         
-        file.close();
-        std::cout << "=== Finished Loading Textures ===" << std::endl;
+        m_rootIsland.assign(m_candidates.size(), kNone);
+        for(std::uint32_t i = 0; i < m_candidates.size(); ++i) {
+            const std::uint32_t root = find(i);
+            if(!m_ready[root]) continue;
+            
+            if(m_rootIsland[root] == kNone) m_rootIsland[root] = allocateIsland();
+            const EntityHandle handle = m_candidates[i].handle;
+            m_islands[m_rootIsland[root]].push_back(handle);
+            m_islandOf[handle.value] = m_rootIsland[root];
+            world.commands().addComponent<SleepingComponent>(handle);
+        }
+    }
+    
+    static constexpr std::uint32_t kNone = UINT32_MAX;
+    
+    std::uint32_t candidateIndex(EntityHandle handle) const {
+        auto found = m_candidateIndex.find(handle.value);
+        return found != m_candidateIndex.end() ? found->second : kNone;
     }
+    
+    std::uint32_t find(std::uint32_t i) {
+        while(m_parent[i] != i) {
+            m_parent[i] = m_parent[m_parent[i]];
+            i = m_parent[i];
+        }
+        return i;
+    }
+    
+    std::uint32_t allocateIsland() {
+        if(!m_freeIslands.empty()) {
+            const std::uint32_t island = m_freeIslands.back();
+            m_freeIslands.pop_back();
+            return island;
+        }
+        m_islands.emplace_back();
+        return static_cast<std::uint32_t>(m_islands.size() - 1);
+    }
+    
+    struct Candidate {
+        EntityHandle handle;
+        PhysicsComponent* physics;
+    };
+    
+    // Sleeping islands, by id; ids of woken islands are reused
+    std::vector<std::vector<EntityHandle>> m_islands;
+    std::vector<std::uint32_t> m_freeIslands;
+    std::unordered_map<std::uint32_t, std::uint32_t> m_islandOf;  // handle value -> island
+    std::uint64_t m_version = 0;  // World structure version pruneDestroyed last ran at
+    
+    // Per-frame scratch for the bodies that may fall asleep
+    std::vector<Candidate> m_candidates;
+    std::unordered_map<std::uint32_t, std::uint32_t> m_candidateIndex;
+    std::vector<std::uint32_t> m_parent;
+    std::vector<bool> m_pinned;
+    std::vector<bool> m_ready;
+    std::vector<std::uint32_t> m_rootIsland;
 };
 
 // ========================
@@ -1260,6 +5132,20 @@ private:
 // ========================
 class Game {
     public:
+        Game()
+            : m_workers(std::max(2u, std::thread::hardware_concurrency()) - 1),
+              m_scheduler(m_workers),
+              m_broadphase(createBroadphase(m_broadphaseKind)) {
+            registerSystems();
+            registerContactSolvers();
+            registerContactEventHandlers();
+            SceneQuery::getInstance().setBroadphase(m_broadphase.get());
+        }
+        
+        ~Game() {
+            SceneQuery::getInstance().setBroadphase(nullptr);
+        }
+        
         bool initialize() {
             // Use Engine for initialization
             if(!Engine::getInstance().initialize("Component-Based Platformer with Sprite Sheets", 800, 600)) {
@@ -1269,7 +5155,7 @@ class Game {
             Engine::getInstance().setTargetFPS(60);
             
             // FORCE COMPLETE CLEANUP - Add these lines
-            m_gameObjects.clear();
+            World::getInstance().clear();
             TextureManager::getInstance().cleanup();
             
             std::cout << "=== LOADING NEW LEVEL ===" << std::endl;
@@ -1282,9 +5168,9 @@ class Game {
             }
             testFile.close();
             // Load game objects from XML
-            m_gameObjects = XMLComponentFactory::createFromXML(Engine::getRenderer(), "scene.xml");
+            auto loadedObjects = XMLComponentFactory::createFromXML(Engine::getRenderer(), "scene.xml");
             
-            if (m_gameObjects.empty()) {
+            if (loadedObjects.empty()) {
                 std::cerr << "ERROR: No game objects loaded from XML!" << std::endl;
                 return false;
             }
@@ -1329,23 +5215,36 @@ class Game {
         
         void shutdown() {
             std::cout << "=== SHUTTING DOWN GAME ===" << std::endl;
-            m_gameObjects.clear();
+            World::getInstance().clear();
             TextureManager::getInstance().cleanup();
             Engine::getInstance().shutdown();
         }
         
+        // Simulate in fixed steps of 1 / ticksPerSecond instead of once per
+        // rendered frame; 0 goes back to one variable step per frame. Swept
+        // collision keeps low tick rates from tunnelling through platforms.
+        void setTickRate(float ticksPerSecond) {
+            m_fixedStep = ticksPerSecond > 0 ? 1.0f / ticksPerSecond : 0.0f;
+            m_stepAccumulator = 0;
+        }
+        
     private:
         void update(float deltaTime) {
-            // Update all game objects using proper deltaTime
-            for(auto& obj : m_gameObjects) {
-                if(obj->isActive) {
-                    obj->update(deltaTime);
+            if(m_fixedStep > 0) {
+                // Past kMaxStepsPerFrame the simulation slows down rather than spiralling;
+                // presses not yet seen by a tick stay latched for the next one
+                m_stepAccumulator += deltaTime;
+                int steps = 0;
+                while(m_stepAccumulator >= m_fixedStep && steps < kMaxStepsPerFrame) {
+                    step(m_fixedStep);
+                    m_stepAccumulator -= m_fixedStep;
+                    steps++;
                 }
+                if(steps == kMaxStepsPerFrame) m_stepAccumulator = 0;
+            } else {
+                step(deltaTime);
             }
             
-            updateCamera();
-            checkCollisions();
-            
             // Optional: Debug FPS display
             static int frameCount = 0;
             static float timeAccumulator = 0.0f;
@@ -1354,11 +5253,86 @@ class Game {
             
             if(timeAccumulator >= 1.0f) {
                 std::cout << "FPS: " << frameCount << ", DeltaTime: " << deltaTime << std::endl;
+                std::cout << "Dormant entities: " << m_lod.dormantCount() << std::endl;
+                std::cout << "Sleeping bodies: " << m_sleep.sleepingCount() << std::endl;
+                std::cout << "Contacts: " << m_contacts.size() << " (" << m_contacts.reusedThisFrame() << " resting)" << std::endl;
+                m_scheduler.logTimings();
                 frameCount = 0;
                 timeAccumulator = 0.0f;
             }
         }
         
+        void step(float dt) {
+            auto& input = InputSystem::getInstance();
+            
+            // F2 cycles the collision broadphase, to compare them in the timing log
+            if(input.isKeyJustPressed(SDL_SCANCODE_F2)) {
+                cycleBroadphase();
+            }
+            
+            // Run all systems using proper deltaTime; non-conflicting ones run in parallel
+            m_scheduler.run(dt);
+            
+            // Apply spawns, destroys and component changes recorded by the systems
+            World::getInstance().flushCommands();
+            
+            // Later ticks of this frame only see presses that come after it
+            input.consumeJustPressed();
+        }
+        
+        void cycleBroadphase() {
+            const int next = (static_cast<int>(m_broadphaseKind) + 1) % static_cast<int>(BroadphaseKind::Count);
+            m_broadphaseKind = static_cast<BroadphaseKind>(next);
+            m_broadphase = createBroadphase(m_broadphaseKind);
+            SceneQuery::getInstance().setBroadphase(m_broadphase.get());
+            std::cout << "Broadphase: " << m_broadphase->name() << std::endl;
+        }
+        
+        // Declares each per-frame system with the components it touches
+        void registerSystems() {
+            auto& world = World::getInstance();
+            
+            m_scheduler.addSystem("integration",
+                componentAccess<PhysicsComponent>(),
+                componentAccess<BodyComponent>(),
+                [&world](float dt) { world.updateComponents<BodyComponent, PhysicsComponent>(dt); });
+            
+            m_scheduler.addSystem("player_controller",
+                kInputResource,
+                componentAccess<ControllerComponent, BodyComponent>(),
+                [&world](float dt) { world.updateComponents<ControllerComponent>(dt); });
+            
+            m_scheduler.addSystem("behaviors",
+                0,
+                componentAccess<PatrolBehaviorComponent, BounceBehaviorComponent,
+                                HorizontalMoveBehaviorComponent, BodyComponent>(),
+                [&world](float dt) {
+                    world.updateComponents<PatrolBehaviorComponent, BounceBehaviorComponent,
+                                           HorizontalMoveBehaviorComponent>(dt);
+                });
+            
+            m_scheduler.addSystem("animation",
+                0,
+                componentAccess<SpriteComponent, TilingBackgroundComponent>(),
+                [&world](float dt) { world.updateComponents<SpriteComponent, TilingBackgroundComponent>(dt); });
+            
+            m_scheduler.addSystem("camera",
+                componentAccess<BodyComponent, ControllerComponent>(),
+                kViewResource,
+                [this](float) { updateCamera(); });
+            
+            m_scheduler.addSystem("collision",
+                componentAccess<SolidComponent, EnemyComponent, TilingBackgroundComponent>(),
+                componentAccess<BodyComponent, ControllerComponent, PhysicsComponent, SleepingComponent>(),
+                [this](float) { checkCollisions(); });
+            
+            m_scheduler.addSystem("simulation_lod",
+                kViewResource | componentAccess<ControllerComponent, TilingBackgroundComponent>(),
+                componentAccess<BodyComponent, PatrolBehaviorComponent, BounceBehaviorComponent,
+                                HorizontalMoveBehaviorComponent, DormantComponent>(),
+                [this, &world](float dt) { m_lod.update(dt, world, Engine::getMainView()); });
+        }
+        
         void render() {
             SDL_Renderer* renderer = Engine::getRenderer();
             
@@ -1369,19 +5343,24 @@ class Game {
             // Get the main view from Engine
             View& mainView = Engine::getMainView();
             
+            auto& world = World::getInstance();
+            
             // Render backgrounds first
-            for(auto& obj : m_gameObjects) {
-                if(obj->isActive && obj->get<TilingBackgroundComponent>()) {
-                    obj->draw(renderer, mainView);
+            world.view<TilingBackgroundComponent>().each([&](GameObject& obj, TilingBackgroundComponent& background) {
+                if(obj.isActive) {
+                    background.draw(renderer, mainView);
                 }
-            }
+            });
+            
+            // Tiles behind everything with a sprite
+            TileCollisionLayer::getInstance().draw(renderer, mainView);
             
             // Then render all other game objects
-            for(auto& obj : m_gameObjects) {
-                if(obj->isActive && !obj->get<TilingBackgroundComponent>()) {
-                    obj->draw(renderer, mainView);
+            world.view<SpriteComponent>().without<TilingBackgroundComponent>().each([&](GameObject& obj, SpriteComponent& sprite) {
+                if(obj.isActive) {
+                    sprite.draw(renderer, mainView);
                 }
-            }
+            });
             
             // Optional: Render debug information
             renderDebugInfo(renderer);
@@ -1390,178 +5369,428 @@ class Game {
         }
         
         void updateCamera() {
-            auto playerObj = findPlayer();
-            if (!playerObj) {
+            // Follow the centre of every camera target, so co-op players share the view
+            float sumX = 0, sumY = 0;
+            int targets = 0;
+            for (GameObject* target : World::getInstance().withRole(EntityRole::CameraTarget)) {
+                if (auto body = target->get<BodyComponent>()) {
+                    sumX += body->x + body->width / 2;
+                    sumY += body->y + body->height / 2;
+                    targets++;
+                }
+            }
+            
+            if (targets == 0) {
                 // Debug: No player found
                 static bool warned = false;
                 if (!warned) {
-                    std::cout << "WARNING: No player object found for camera tracking!" << std::endl;
+                    std::cout << "WARNING: No camera target found for camera tracking!" << std::endl;
                     warned = true;
                 }
                 return;
             }
             
-            auto playerBody = playerObj->get<BodyComponent>();
-            if(playerBody) {
-                // Update engine's main view to follow player
-                View& mainView = Engine::getMainView();
-                mainView.setCenter(
-                    playerBody->x + playerBody->width / 2,
-                    playerBody->y + playerBody->height / 2
-                );
-                
-                // Optional: Add camera smoothing or bounds checking here
+            // Update engine's main view to follow the targets
+            Engine::getMainView().setCenter(sumX / targets, sumY / targets);
+            
+            // Optional: Add camera smoothing or bounds checking here
+        }
+        
+        // A contact worked out by a task, applied to the cache and event buffer when merged
+        struct ResolvedContact {
+            EntityHandle self;
+            EntityHandle other;
+            ContactCache::Contact contact;
+            ContactPhase phase;
+        };
+        
+        // Scratch and results for one run of bodies, so runs can resolve in parallel
+        struct ContactTask {
+            std::vector<std::uint32_t> hits;
+            std::vector<const BroadphaseProxy*> candidates;
+            AabbBatch candidateBoxes;
+            std::vector<std::uint64_t> hitMask;
+            std::vector<ResolvedContact> resolved;
+        };
+        
+        // Positional response to one contact; records it in 'contact' and
+        // returns false to stop resolving the rest of self's contacts this frame
+        using ContactSolver = bool (Game::*)(ContactCache::Contact& contact, BodyComponent& selfBody, const BroadphaseProxy& other);
+        
+        // Gameplay response to a frame's events for one layer pair
+        using ContactEventHandler = void (Game::*)(const std::vector<ContactEvent>& events);
+        
+        // Solvers by (layer of the body resolving, layer of what it touched).
+        // A body resolves its own contacts if its layer has any entry here.
+        void registerContactSolvers() {
+            solveContacts(CollisionLayer::Player, CollisionLayer::Enemy, &Game::solvePlayerEnemy);
+            solveContacts(CollisionLayer::Player, CollisionLayer::Solid, &Game::solvePlayerSolid);
+            solveContacts(CollisionLayer::Enemy, CollisionLayer::Solid, &Game::solveEnemySolid);
+        }
+        
+        void solveContacts(CollisionLayer self, CollisionLayer other, ContactSolver solver) {
+            m_contactSolvers[static_cast<std::size_t>(self)][static_cast<std::size_t>(other)] = solver;
+            m_resolvingLayers |= layerBit(self);
+        }
+        
+        // Event handlers run in this order once all contacts are resolved;
+        // deaths come last so they win over a landing in the same frame
+        void registerContactEventHandlers() {
+            onContactEvents(CollisionLayer::Player, CollisionLayer::Solid, &Game::playerSolidEvents);
+            onContactEvents(CollisionLayer::Player, CollisionLayer::Enemy, &Game::playerEnemyEvents);
+        }
+        
+        void onContactEvents(CollisionLayer self, CollisionLayer other, ContactEventHandler handler) {
+            m_contactEventHandlers.push_back({ self, other, handler });
+        }
+        
+        void checkCollisions() {
+            auto& world = World::getInstance();
+            StaticBvh::getInstance().refresh(world);
+            m_broadphase->build(world);
+            m_contacts.beginFrame();
+            m_contactEvents.clear();
+            
+            // Players first, then enemies, as before; sleeping bodies stay put
+            const std::uint32_t proxyCount = static_cast<std::uint32_t>(m_broadphase->proxyCount());
+            for (CollisionLayer layer : { CollisionLayer::Player, CollisionLayer::Enemy }) {
+                if (!(m_resolvingLayers & layerBit(layer))) continue;
+                m_movers.clear();
+                for (std::uint32_t i = 0; i < proxyCount; ++i) {
+                    const BroadphaseProxy& proxy = m_broadphase->proxy(i);
+                    if (proxy.layer == layerBit(layer) && !proxy.object->has<SleepingComponent>()) m_movers.push_back(i);
+                }
+                resolveLayer(layer);
+            }
+            
+            // A sleeping body keeps its contacts for as long as the other body exists
+            auto keepSleeping = [&world](EntityHandle self, EntityHandle other) {
+                GameObject* obj = world.resolve(self);
+                return obj && obj->has<SleepingComponent>() && world.resolve(other);
+            };
+            m_contacts.endFrame(keepSleeping, [this](EntityHandle self, EntityHandle other, const ContactCache::Contact& contact) {
+                m_contactEvents.push({ self, other, contact.selfLayer, contact.otherLayer, ContactPhase::Exit, contact.normal });
+            });
+            
+            for (const auto& entry : m_contactEventHandlers) {
+                const auto& events = m_contactEvents.batch(entry.self, entry.other);
+                if (!events.empty()) (this->*entry.handler)(events);
             }
+            
+            m_sleep.update(world, *m_broadphase, m_contactEvents);
         }
         
-        GameObject* findPlayer() {
-            for(auto& obj : m_gameObjects) {
-                if(obj->get<ControllerComponent>()) {
-                    return obj.get();
+        // Resolves the contacts of the bodies in m_movers, all on 'layer'.
+        // Each body only writes itself and, unless the layer has a solver
+        // against itself, only reads bodies on other layers, so fixed runs of
+        // kMoversPerTask bodies are resolved in parallel. Runs are merged in
+        // order, so the contact cache and events come out exactly as a serial
+        // pass would leave them.
+        void resolveLayer(CollisionLayer layer) {
+            const std::size_t taskCount = (m_movers.size() + kMoversPerTask - 1) / kMoversPerTask;
+            if (m_contactTasks.size() < taskCount) m_contactTasks.resize(taskCount);
+            
+            auto runTask = [this](std::size_t t) {
+                ContactTask& task = m_contactTasks[t];
+                task.resolved.clear();
+                const std::size_t end = std::min(m_movers.size(), (t + 1) * kMoversPerTask);
+                for (std::size_t i = t * kMoversPerTask; i < end; ++i) {
+                    resolveContacts(m_movers[i], task);
+                }
+            };
+            
+            const std::size_t index = static_cast<std::size_t>(layer);
+            if (m_contactSolvers[index][index]) {
+                for (std::size_t t = 0; t < taskCount; ++t) runTask(t);  // order within the layer matters
+            } else {
+                m_workers.parallelFor(taskCount, runTask);
+            }
+            
+            for (std::size_t t = 0; t < taskCount; ++t) {
+                for (const ResolvedContact& resolved : m_contactTasks[t].resolved) {
+                    const ContactCache::Contact& contact = resolved.contact;
+                    m_contacts.touch(resolved.self, resolved.other) = contact;
+                    m_contactEvents.push({ resolved.self, resolved.other, contact.selfLayer, contact.otherLayer,
+                                           resolved.phase, contact.normal });
                 }
             }
-            return nullptr;
         }
         
-        void checkCollisions() {
-            auto playerObj = findPlayer();
-            if (!playerObj) return;
+        // Bodies that may touch proxy 'index': static level geometry under its
+        // box first, then its pairs from the dynamic broadphase, keeping those
+        // with a solver. Their current bounds are packed into the task's
+        // candidateBoxes for the batch overlap test.
+        void gatherCandidates(std::uint32_t index, ContactTask& task) {
+            task.candidates.clear();
             
-            auto playerBody = playerObj->get<BodyComponent>();
-            auto playerController = playerObj->get<ControllerComponent>();
+            const BroadphaseProxy& self = m_broadphase->proxy(index);
+            const auto& solvers = m_contactSolvers[static_cast<std::size_t>(self.body->layer)];
+            auto hasSolver = [&solvers](const BroadphaseProxy& other) {
+                return solvers[static_cast<std::size_t>(other.body->layer)] != nullptr;
+            };
             
-            if(!playerBody || !playerController || playerController->isDead()) return;
+            const StaticBvh& statics = StaticBvh::getInstance();
+            task.hits.clear();
+            statics.query(self.bounds, task.hits);
+            for (std::uint32_t hit : task.hits) {
+                const BroadphaseProxy& other = statics.proxy(hit);
+                if (canCollide(self, other) && hasSolver(other)) task.candidates.push_back(&other);
+            }
             
-            // Reset platform status
-            playerController->setOnPlatform(false, nullptr);
+            for (std::uint32_t partner : m_broadphase->partners(index)) {
+                const BroadphaseProxy& other = m_broadphase->proxy(partner);
+                if (hasSolver(other)) task.candidates.push_back(&other);
+            }
             
-            // Check collisions with all other objects
-            for(size_t i = 0; i < m_gameObjects.size(); ++i) {
-                auto otherObj = m_gameObjects[i].get();
-                
-                // Skip the player object itself and background objects
-                if(otherObj == playerObj || otherObj->get<TilingBackgroundComponent>()) {
-                    continue;
-                }
-                
-                auto otherBody = otherObj->get<BodyComponent>();
-                auto otherSolid = otherObj->get<SolidComponent>();
-                auto otherEnemy = otherObj->get<EnemyComponent>();
-                
-                if(!otherBody) continue;
+            task.candidateBoxes.clear();
+            for (const BroadphaseProxy* candidate : task.candidates) {
+                task.candidateBoxes.push(Aabb::of(*candidate->body));
+            }
+        }
+        
+        // Calls onHit(candidate) for each gathered candidate overlapping 'body',
+        // in order, until it returns false. Hits come from the batch kernel;
+        // when a contact moves the body, the rest are re-tested from its new spot.
+        template<typename Fn>
+        void forEachOverlap(BodyComponent& body, ContactTask& task, Fn&& onHit) {
+            std::size_t next = 0;
+            while (next < task.candidates.size()) {
+                const std::size_t first = next;
+                overlapBatch(Aabb::of(body), task.candidateBoxes, first, task.hitMask);
                 
-                // Check player collisions - USE FULL BODY SIZE (no scaling)
-                if(CollisionSystem::checkCollision(playerBody, otherBody)) {
-                    // Check if it's an enemy - if so, player dies and respawns
-                    if(otherEnemy) {
-                        std::cout << "Player died by enemy collision!" << std::endl;
-                        playerController->die();
-                        return; // Stop checking other collisions
-                    }
-                    
-                    // Check if it's a solid object for platform collision
-                    if(otherSolid) {
-                        float platformVelocityX = otherBody->getVelocityX();
-                        bool landedOnPlatform = CollisionSystem::resolvePlatformCollision(playerBody, otherBody, platformVelocityX);
-                        if(landedOnPlatform) {
-                            playerController->setOnPlatform(true, otherObj);
+                bool moved = false;
+                for (std::size_t word = 0; word < task.hitMask.size() && !moved; ++word) {
+                    for (std::uint64_t bits = task.hitMask[word]; bits; bits &= bits - 1) {
+                        const std::size_t i = first + word * 64 + static_cast<std::size_t>(lowestSetBit64(bits));
+                        const float x = body.x, y = body.y;
+                        if (!onHit(*task.candidates[i])) return;
+                        next = i + 1;
+                        if (body.x != x || body.y != y) {
+                            moved = true;
+                            break;
                         }
                     }
                 }
+                if (!moved) return;
+            }
+        }
+        
+        // Continuous pass, run before the overlap tests. A body that moved far
+        // enough this frame can pass through a thin solid and come out the
+        // other side, where the overlap tests never see it. Sweeps the move
+        // against the solid candidates it does not end up inside; if it went
+        // clean through one, the body is put back at the time of impact,
+        // kSweepSkin into it along the contact normal, so the usual resolution
+        // pushes it out on the side it came from. Grazing past a corner is
+        // left alone. Motion is taken relative to each candidate, so moving
+        // platforms are swept too.
+        void sweepAgainstSolids(BodyComponent& body, const ContactTask& task) {
+            const Aabb end = Aabb::of(body);
+            const Aabb start{ body.prevX, body.prevY, body.prevX + body.width, body.prevY + body.height };
+            
+            const BodyComponent* first = nullptr;
+            SweepHit firstHit{ 1.0f, false, 1.0f };
+            float firstDx = 0, firstDy = 0;
+            for (const BroadphaseProxy* candidatePtr : task.candidates) {
+                const BroadphaseProxy& candidate = *candidatePtr;
+                if (candidate.layer != layerBit(CollisionLayer::Solid)) continue;
                 
-                // Handle enemy physics with platforms
-                if(otherEnemy) {
-                    auto enemyBody = otherBody;
-                    auto enemyPhysics = otherObj->get<PhysicsComponent>();
-                    
-                    // Only check collisions for enemies that have physics (gravity)
-                    if(enemyPhysics) {
-                        for(size_t j = 0; j < m_gameObjects.size(); ++j) {
-                            // Don't check collision with self or background
-                            if(i == j || m_gameObjects[j].get()->get<TilingBackgroundComponent>()) {
-                                continue;
-                            }
-                            
-                            auto groundObj = m_gameObjects[j].get();
-                            auto groundBody = groundObj->get<BodyComponent>();
-                            auto groundSolid = groundObj->get<SolidComponent>();
-                            
-                            if(!groundBody || !groundSolid) continue;
-                            
-                            // Check if enemy is colliding with solid ground
-                            if(CollisionSystem::checkCollision(enemyBody, groundBody)) {
-                                // Simple ground collision resolution for enemies
-                                float overlapTop = (enemyBody->y + enemyBody->height) - groundBody->y;
-                                float overlapBottom = (groundBody->y + groundBody->height) - enemyBody->y;
-                                
-                                // If enemy is above the ground (landing on it)
-                                if(std::abs(overlapTop) < std::abs(overlapBottom)) {
-                                    enemyBody->y = groundBody->y - enemyBody->height;
-                                    enemyBody->velocityY = 0;
-                                }
-                            }
-                        }
-                    }
+                const BodyComponent& solid = *candidate.body;
+                if (end.overlaps(Aabb::of(solid))) continue;
+                
+                const float dx = (body.x - body.prevX) - solid.getVelocityX();
+                const float dy = (body.y - body.prevY) - solid.getVelocityY();
+                const Aabb solidStart{ solid.prevX, solid.prevY, solid.prevX + solid.width, solid.prevY + solid.height };
+                SweepHit hit;
+                if (sweepAabb(start, dx, dy, solidStart, hit) && hit.exitTime <= 1 && hit.time < firstHit.time) {
+                    first = &solid;
+                    firstHit = hit;
+                    firstDx = dx;
+                    firstDy = dy;
                 }
             }
+            if (!first) return;
+            
+            // Place relative to where the solid is now
+            float x = first->x + (body.prevX - first->prevX) + firstDx * firstHit.time;
+            float y = first->y + (body.prevY - first->prevY) + firstDy * firstHit.time;
+            if (firstHit.alongX) {
+                x += firstDx > 0 ? kSweepSkin : -kSweepSkin;
+            } else {
+                y += firstDy > 0 ? kSweepSkin : -kSweepSkin;
+            }
+            body.x = x;
+            body.y = y;
         }
         
-        void debugLoadedObjects() {
-            std::cout << "=== LOADED OBJECTS DEBUG ===" << std::endl;
-            int platformCount = 0;
-            int movingPlatformCount = 0;
-            int enemyCount = 0;
-            int playerCount = 0;
-            int backgroundCount = 0;
-            int totalObjects = 0;
-            
-            for(auto& obj : m_gameObjects) {
-                totalObjects++;
+        // Runs the solver for each contact of proxy 'proxyIndex', in candidate
+        // order, until one returns false, and records each in task.resolved
+        void resolveContacts(std::uint32_t proxyIndex, ContactTask& task) {
+            const BroadphaseProxy& self = m_broadphase->proxy(proxyIndex);
+            GameObject& obj = *self.object;
+            BodyComponent& body = *self.body;
+            
+            // Controlled bodies re-derive their platform each frame
+            if (auto controller = obj.get<ControllerComponent>()) {
+                if (controller->isDead()) return;
+                controller->setOnPlatform(false);
+            }
+            
+            gatherCandidates(proxyIndex, task);
+            sweepAgainstSolids(body, task);
+            
+            const auto& solvers = m_contactSolvers[static_cast<std::size_t>(body.layer)];
+            forEachOverlap(body, task, [&](const BroadphaseProxy& other) {
+                const ContactSolver solver = solvers[static_cast<std::size_t>(other.body->layer)];
+                ResolvedContact resolved{ self.handle, other.handle, m_contacts.find(self.handle, other.handle), ContactPhase::Enter };
+                if (m_contacts.touchedLastFrame(resolved.contact)) resolved.phase = ContactPhase::Stay;
                 
-                if(obj->get<SolidComponent>()) {
-                    platformCount++;
-                    if(obj->get<HorizontalMoveBehaviorComponent>()) {
-                        movingPlatformCount++;
-                    }
-                }
-                if(obj->get<EnemyComponent>()) {
-                    enemyCount++;
-                }
-                if(obj->get<ControllerComponent>()) {
-                    playerCount++;
+                const bool keepGoing = (this->*solver)(resolved.contact, body, other);
+                task.resolved.push_back(resolved);
+                return keepGoing;
+            });
+            
+            resolveTiles(obj, body);
+        }
+        
+        // Tiles last, so a contact with a body cannot leave this one inside
+        // them. They block from every side, for enemies too, and are level
+        // geometry: not entities, so they make no contacts or events, and
+        // standing on them grounds a controller without carrying it.
+        void resolveTiles(GameObject& obj, BodyComponent& body) {
+            const auto& solvers = m_contactSolvers[static_cast<std::size_t>(body.layer)];
+            if (!solvers[static_cast<std::size_t>(CollisionLayer::Solid)] || !(body.collidesWith & layerBit(CollisionLayer::Solid))) return;
+            
+            const TileCollisionLayer::Contact contact = TileCollisionLayer::getInstance().resolve(body);
+            if (contact.alongY != ContactNormal::Top) return;
+            if (auto controller = obj.get<ControllerComponent>()) {
+                controller->setGrounded(true);
+            }
+        }
+        
+        // Player collisions use the full body size (no scaling). Touching an
+        // enemy is fatal, so nothing else is resolved for the player this frame.
+        bool solvePlayerEnemy(ContactCache::Contact& contact, BodyComponent& playerBody, const BroadphaseProxy& enemy) {
+            m_contacts.store(contact, ContactNormal::None, 0, playerBody, *enemy.body);
+            return false; // Stop checking other collisions
+        }
+        
+        bool solvePlayerSolid(ContactCache::Contact& contact, BodyComponent& playerBody, const BroadphaseProxy& solid) {
+            ContactNormal normal = m_contacts.restingNormal(contact, playerBody, *solid.body);
+            if (normal == ContactNormal::None) {
+                normal = CollisionSystem::platformContactNormal(&playerBody, solid.body);
+            }
+            const float separation = CollisionSystem::penetration(playerBody, *solid.body, normal);
+            
+            float platformVelocityX = solid.body->getVelocityX();
+            CollisionSystem::applyPlatformContact(&playerBody, solid.body, normal, platformVelocityX);
+            m_contacts.store(contact, normal, separation, playerBody, *solid.body);
+            return true;
+        }
+        
+        // Enemies only collide with solids if they have physics (gravity)
+        bool solveEnemySolid(ContactCache::Contact& contact, BodyComponent& enemyBody, const BroadphaseProxy& ground) {
+            const BodyComponent& groundBody = *ground.body;
+            ContactNormal normal = m_contacts.restingNormal(contact, enemyBody, groundBody);
+            if (normal == ContactNormal::None) {
+                // Simple ground collision resolution for enemies
+                float overlapTop = (enemyBody.y + enemyBody.height) - groundBody.y;
+                float overlapBottom = (groundBody.y + groundBody.height) - enemyBody.y;
+                
+                // Only landing on it is resolved; Bottom is remembered but left alone
+                normal = std::abs(overlapTop) < std::abs(overlapBottom) ? ContactNormal::Top : ContactNormal::Bottom;
+            }
+            const float separation = CollisionSystem::penetration(enemyBody, groundBody, normal);
+            
+            // If enemy is above the ground (landing on it)
+            if(normal == ContactNormal::Top) {
+                enemyBody.y = groundBody.y - enemyBody.height;
+                enemyBody.velocityY = 0;
+            }
+            m_contacts.store(contact, normal, separation, enemyBody, groundBody);
+            return true;
+        }
+        
+        // Standing on top of a solid attaches the player to it
+        void playerSolidEvents(const std::vector<ContactEvent>& events) {
+            auto& world = World::getInstance();
+            for (const ContactEvent& event : events) {
+                if (event.phase == ContactPhase::Exit || event.normal != ContactNormal::Top) continue;
+                GameObject* player = world.resolve(event.self);
+                if (!player) continue;
+                if (auto controller = player->get<ControllerComponent>()) {
+                    controller->setOnPlatform(true, event.other);
                 }
-                if(obj->get<TilingBackgroundComponent>()) {
-                    backgroundCount++;
+            }
+        }
+        
+        // Check if it's an enemy - if so, player dies and respawns
+        void playerEnemyEvents(const std::vector<ContactEvent>& events) {
+            auto& world = World::getInstance();
+            for (const ContactEvent& event : events) {
+                if (event.phase == ContactPhase::Exit) continue;
+                GameObject* player = world.resolve(event.self);
+                if (!player) continue;
+                auto controller = player->get<ControllerComponent>();
+                if (controller && !controller->isDead()) {
+                    std::cout << "Player died by enemy collision!" << std::endl;
+                    controller->die();
                 }
             }
+        }
+        
+        void debugLoadedObjects() {
+            std::cout << "=== LOADED OBJECTS DEBUG ===" << std::endl;
+            auto& world = World::getInstance();
             
-            std::cout << "Total GameObjects: " << totalObjects << std::endl;
-            std::cout << "Players: " << playerCount << std::endl;
-            std::cout << "Platforms: " << platformCount << " (moving: " << movingPlatformCount << ")" << std::endl;
-            std::cout << "Enemies: " << enemyCount << std::endl;
-            std::cout << "Backgrounds: " << backgroundCount << std::endl;
+            std::cout << "Total GameObjects: " << world.entities().size() << std::endl;
+            std::cout << "Players: " << world.withRole(EntityRole::Player).size() << std::endl;
+            std::cout << "Platforms: " << world.view<SolidComponent>().size()
+                      << " (moving: " << world.view<SolidComponent, HorizontalMoveBehaviorComponent>().size() << ")" << std::endl;
+            std::cout << "Enemies: " << world.view<EnemyComponent>().size() << std::endl;
+            std::cout << "Backgrounds: " << world.view<TilingBackgroundComponent>().size() << std::endl;
+            const TileCollisionLayer& tiles = TileCollisionLayer::getInstance();
+            std::cout << "Tiles: " << tiles.solidCount() << " solid of " << tiles.width() << "x" << tiles.height() << std::endl;
+            std::cout << "Archetypes: " << world.archetypeCount() << std::endl;
+            std::cout << "Overlap kernel: " << overlapKernel().name << std::endl;
+            logPoolStats();
             
             // Log positions of first few platforms for verification
             int loggedPlatforms = 0;
-            for(auto& obj : m_gameObjects) {
-                if(obj->get<SolidComponent>() && loggedPlatforms < 5) {
-                    auto body = obj->get<BodyComponent>();
-                    if(body) {
-                        std::cout << "Platform " << (loggedPlatforms + 1) << " at: " 
-                                  << body->x << "," << body->y << " size: " 
-                                  << body->width << "x" << body->height << std::endl;
-                        loggedPlatforms++;
-                    }
+            world.view<BodyComponent, SolidComponent>().each([&loggedPlatforms](GameObject&, BodyComponent& body, SolidComponent&) {
+                if(loggedPlatforms < 5) {
+                    std::cout << "Platform " << (loggedPlatforms + 1) << " at: " 
+                              << body.x << "," << body.y << " size: " 
+                              << body.width << "x" << body.height << std::endl;
+                    loggedPlatforms++;
                 }
-            }
+            });
             std::cout << "=============================" << std::endl;
         }
         
+        // Occupancy and high-water marks of the entity and component pools
+        void logPoolStats() {
+            const PoolStats& entityStats = World::getInstance().entityPoolStats();
+            std::cout << "Pool GameObject: " << entityStats.live << " live, "
+                      << entityStats.highWater << " peak, " << entityStats.capacity << " capacity" << std::endl;
+            
+            std::size_t typeId = 0;
+            TypeListVisitor<ComponentTypes>::visit([&typeId](auto* tag) {
+                using T = std::remove_pointer_t<decltype(tag)>;
+                if constexpr (isTagComponent<T>()) {
+                    std::cout << "Pool " << kComponentTypeNames[typeId++] << ": tag, mask bit only" << std::endl;
+                } else {
+                    PoolStats stats = ComponentPool<T>::getInstance().stats();
+                    std::cout << "Pool " << kComponentTypeNames[typeId++] << ": " << stats.live << " live, "
+                              << stats.highWater << " peak, " << stats.capacity << " capacity" << std::endl;
+                }
+            });
+        }
+        
         void renderDebugInfo(SDL_Renderer* renderer) {
             View& mainView = Engine::getMainView(); // Add this line if missing
             
-            auto playerObj = findPlayer();
-            if (playerObj) {
+            for (GameObject* playerObj : World::getInstance().withRole(EntityRole::Player)) {
                 auto playerBody = playerObj->get<BodyComponent>();
                 if (playerBody) {
                     // Draw the ACTUAL collision box (full size - no scaling)
@@ -1587,15 +5816,64 @@ class Game {
             }
         }
         
-        std::vector<std::unique_ptr<GameObject>> m_gameObjects;
+        WorkerPool m_workers;
+        SystemScheduler m_scheduler;
+        SimulationLOD m_lod;
+        SleepIslands m_sleep;
+        BroadphaseKind m_broadphaseKind = BroadphaseKind::SweepAndPrune;
+        std::unique_ptr<Broadphase> m_broadphase;  // moving bodies; level geometry is in StaticBvh
+        
+        static constexpr std::size_t kMoversPerTask = 64;
+        std::vector<std::uint32_t> m_movers;
+        std::vector<ContactTask> m_contactTasks;
+        
+        struct ContactEventEntry {
+            CollisionLayer self;
+            CollisionLayer other;
+            ContactEventHandler handler;
+        };
+        
+        std::array<std::array<ContactSolver, kCollisionLayerCount>, kCollisionLayerCount> m_contactSolvers{};
+        std::vector<ContactEventEntry> m_contactEventHandlers;
+        ContactEventBuffer m_contactEvents;
+        LayerMask m_resolvingLayers = 0;
+        ContactCache m_contacts;
+        
+        // How far into a solid the swept pass leaves a body, so it still overlaps
+        static constexpr float kSweepSkin = 0.5f;
+        static constexpr int kMaxStepsPerFrame = 8;
+        float m_fixedStep = 0;
+        float m_stepAccumulator = 0;
     };
 
 // ========================
 // Main
 // ========================
-int main() {
+int main(int argc, char* argv[]) {
     Game game;
     
+    // --tick-rate N simulates at a fixed N ticks per second
+    for(int i = 1; i < argc; ++i) {
+        if(std::string(argv[i]) != "--tick-rate") continue;
+        
+        float ticksPerSecond = -1;
+        if(i + 1 < argc) {
+            try {
+                std::size_t parsed = 0;
+                ticksPerSecond = std::stof(argv[i + 1], &parsed);
+                if(argv[i + 1][parsed] != '\0') ticksPerSecond = -1;
+            } catch(const std::exception&) {
+                ticksPerSecond = -1;
+            }
+        }
+        if(!(ticksPerSecond >= 0) || !std::isfinite(ticksPerSecond)) {
+            std::cerr << "Usage: " << argv[0] << " [--tick-rate N]  (N ticks per second, 0 for one step per frame)" << std::endl;
+            return 1;
+        }
+        game.setTickRate(ticksPerSecond);
+        ++i;
+    }
+    
     if(!game.initialize()) {
         return 1;
     }